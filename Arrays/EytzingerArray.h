@@ -0,0 +1,160 @@
+/* Static search index over sorted keys in Eytzinger (breadth first) order.
+*
+* std::binary_search on a large sorted array misses the cache on nearly every step: the first
+* probes of all searches share a few lines, but after that each halving jumps to a line that is
+* unlikely to be cached. EytzingerArray stores the same keys as an implicit binary search tree laid
+* out level by level, node k having children 2k and 2k+1. The top levels then sit together in a
+* few cache lines that stay hot, and the 16 (for 4 byte keys) great-great-grandchildren of a node
+* are one aligned cache line, so each search prefetches the line it needs four steps ahead while
+* those steps run. The descent has no data dependent branch: it is k = 2k + (key < x).
+*
+*	std::vector<int> keys = ...;	// sorted
+*	EytzingerArray<int> index(keys);
+*	size_t pos = index.lower_bound(x);	// same as std::lower_bound(keys.begin(), keys.end(), x) - keys.begin()
+*	bool found = index.contains(x);
+*
+* The index is a copy of the keys, built in O(n); it cannot be modified.
+*/
+#ifndef EytzingerArray_H
+#define EytzingerArray_H
+
+#include <assert.h>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+template<class T>
+class EytzingerArray
+{
+	static_assert(std::is_trivially_copyable_v<T>, "keys are copied as raw storage");
+
+	static constexpr size_t cache_line = 64;
+	// Keys per cache line; node k's descendants `block` levels down are the line starting at k * block.
+	static constexpr size_t block = sizeof(T) < cache_line ? cache_line / sizeof(T) : 1;
+
+	struct AlignedDelete
+	{
+		void operator()(T* p) const
+		{
+			::operator delete(p, std::align_val_t(cache_line));
+		}
+	};
+
+	// _t[1.._n] is the tree; _t[0] is unused so that the children of k are 2k and 2k+1.
+	std::unique_ptr<T[], AlignedDelete> _t;
+	size_t _n = 0;
+
+	public:
+
+	EytzingerArray() = default;
+	explicit EytzingerArray(const std::vector<T>& sorted): EytzingerArray(std::span<const T>(sorted)) {}
+	explicit EytzingerArray(std::span<const T> sorted);
+
+	size_t size() const
+	{
+		return _n;
+	}
+
+	bool empty() const
+	{
+		return _n == 0;
+	}
+
+	// Position of the first key not less than x in the sorted input, size() if there is none.
+	size_t lower_bound(const T& x) const
+	{
+		const size_t k = lower_bound_node(x);
+		return k == 0 ? _n : rank(k);
+	}
+
+	bool contains(const T& x) const
+	{
+		const size_t k = lower_bound_node(x);
+		return k != 0 && !(x < _t[k]);
+	}
+
+	size_t memory_bytes() const
+	{
+		return (_n + 1) * sizeof(T);
+	}
+
+	private:
+
+	size_t lower_bound_node(const T& x) const;
+	size_t rank(const size_t k) const;
+	size_t fill(std::span<const T> sorted, size_t i, const size_t k);
+};
+
+template<class T>
+EytzingerArray(const std::vector<T>&) -> EytzingerArray<T>;
+
+template<class T>
+EytzingerArray<T>::EytzingerArray(std::span<const T> sorted): _n(sorted.size())
+{
+	assert(std::is_sorted(sorted.begin(), sorted.end()));
+
+	// Cache line aligned so that _t[k * block] starts a line.
+	_t.reset(static_cast<T*>(::operator new((_n + 1) * sizeof(T), std::align_val_t(cache_line))));
+	std::uninitialized_value_construct_n(_t.get(), _n + 1);
+
+	fill(sorted, 0, 1);
+}
+
+// In-order walk of the implicit tree rooted at k, assigning sorted[i..] to its nodes. The depth is
+// log2(n), so the recursion is shallow.
+template<class T>
+size_t EytzingerArray<T>::fill(std::span<const T> sorted, size_t i, const size_t k)
+{
+	if(k <= _n)
+	{
+		i = fill(sorted, i, 2 * k);
+		_t[k] = sorted[i++];
+		i = fill(sorted, i, 2 * k + 1);
+	}
+
+	return i;
+}
+
+// Returns the node holding the first key not less than x, 0 if every key is less.
+template<class T>
+size_t EytzingerArray<T>::lower_bound_node(const T& x) const
+{
+	size_t k = 1;
+	while(k <= _n)
+	{
+		// Near the leaves this prefetches past the tree, which is harmless: a prefetch never faults.
+		__builtin_prefetch(reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(_t.get()) + k * block * sizeof(T)));
+		k = 2 * k + (_t[k] < x);
+	}
+
+	// Each bit of k records a step right (key < x) or left; the answer is the last node where the
+	// descent went left, found by dropping the trailing right steps and that left step.
+	return k >> std::countr_one(k) >> 1;
+}
+
+// Position of node k in the sorted order. In the perfect tree with the same number of levels, a
+// node at depth d and position p within its level is preceded by (2p + 1) * 2^(levels - 1 - d) - 1
+// nodes. There every second node of the in-order sequence is on the last level, and the nodes
+// missing from a partial last level are its rightmost ones, so those that would precede k are
+// subtracted.
+template<class T>
+size_t EytzingerArray<T>::rank(const size_t k) const
+{
+	const int levels = std::bit_width(_n);
+	const int d = std::bit_width(k) - 1;
+	const size_t p = k - (size_t(1) << d);
+	const size_t perfect_rank = ((2 * p + 1) << (levels - 1 - d)) - 1;
+
+	const size_t last_level = size_t(1) << (levels - 1);
+	const size_t present = _n - last_level + 1;
+	const size_t before = std::min((perfect_rank + 1) / 2, last_level);
+	return perfect_rank - (before > present ? before - present : 0);
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Benchmark extending array_accumulate.cpp, min_element_array.cpp and max_element_array.cpp.
+ * std::accumulate, std::min_element and std::max_element are compared with the vectorized
+ * bulk_sum, bulk_min and bulk_max kernels from DynamicArray/BulkOps.h, once with the kernel
+ * selected for this CPU and once with the scalar fallback.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <string>
+#include <cmath>
+#include <assert.h>
+#include <stdlib.h>
+#include "../DynamicArray/BulkOps.h"
+
+const int repeat = 20;
+
+template<class Fn>
+auto time_test(Fn fn, const std::string& msg, const size_t len)
+{
+	auto result = fn();
+	auto start = std::chrono::steady_clock::now();
+	for(int I = 0; I < repeat; ++I)
+	{
+		result = fn();
+		asm volatile("" : : "g"(&result) : "memory");
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	const double ns = std::chrono::duration<double, std::nano>(end-start).count() / repeat;
+	std::cout << "\n" << msg << ns / 1e6 << " milli-seconds (" << len * 1.0 / ns << " G elements/sec)";
+	return result;
+}
+
+template<class T>
+void benchmark(const std::string& type, const size_t len)
+{
+	DynamicArray<T> numbers(len);
+	srand(1);
+	for(size_t I = 0; I < len; ++I)
+		numbers[I] = static_cast<T>(rand() % 1000 - 500);
+
+	const T* begin = numbers.data();
+	const T* end = begin + len;
+	const SimdLevel level = bulk_simd_level;
+
+	std::cout << "\n\n" << type << ", " << len << " elements";
+
+	T sum1 = time_test([&]() { return std::accumulate(begin, end, T(0)); }, "std::accumulate = ", len);
+	T sum2 = time_test([&]() { return bulk_sum(numbers); }, "bulk_sum = ", len);
+	bulk_simd_level = SimdLevel::Scalar;
+	T sum3 = time_test([&]() { return bulk_sum(numbers); }, "bulk_sum (scalar) = ", len);
+	bulk_simd_level = level;
+	assert(std::abs(sum1 - sum2) <= std::abs(sum1) * 1e-5);
+	assert(sum1 == sum3);
+
+	T mn1 = time_test([&]() { return *std::min_element(begin, end); }, "std::min_element = ", len);
+	T mn2 = time_test([&]() { return bulk_min(numbers); }, "bulk_min = ", len);
+	assert(mn1 == mn2);
+
+	T mx1 = time_test([&]() { return *std::max_element(begin, end); }, "std::max_element = ", len);
+	T mx2 = time_test([&]() { return bulk_max(numbers); }, "bulk_max = ", len);
+	assert(mx1 == mx2);
+
+	DynamicArray<T> y(len);
+	time_test([&]() { bulk_fill(y, T(1)); return y[len-1]; }, "bulk_fill = ", len);
+	time_test([&]() { bulk_scaled_add(y, T(2), numbers); return y[len-1]; }, "bulk_scaled_add = ", len);
+	assert(y[0] == T(1) + T(2) * (repeat + 1) * numbers[0]);
+}
+
+int main()
+{
+	const size_t len = 10000000;
+	benchmark<int>("int", len);
+	benchmark<float>("float", len);
+	benchmark<double>("double", len);
+	std::cout << std::endl;
+	return 0;
+}
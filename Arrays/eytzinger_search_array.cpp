@@ -0,0 +1,100 @@
+/*
+ * Benchmark extending binary_search_array.cpp to large sorted arrays.
+ * std::binary_search and std::lower_bound on a sorted array are compared with contains and
+ * lower_bound of EytzingerArray, which holds the same keys in breadth first order, for arrays from
+ * a few KB (in L1) to hundreds of MB (in DRAM). Every search result is checked against std.
+ *
+ *	g++ -std=c++20 -O2 -DNDEBUG eytzinger_search_array.cpp -o eytzinger_search_array
+ *	./eytzinger_search_array [max_log2_size]	(default 26, i.e. up to 64M ints)
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <stdlib.h>
+#include "EytzingerArray.h"
+
+const int num_queries = 2000000;
+
+template<class Fn>
+long long time_test(Fn fn, const std::vector<int>& queries, const std::string& msg)
+{
+	long long checksum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(const int x: queries)
+		checksum += fn(x);
+	auto end = std::chrono::steady_clock::now();
+
+	const double ns = std::chrono::duration<double, std::nano>(end-start).count() / queries.size();
+	std::cout << "\n  " << std::left << std::setw(30) << msg << std::right << std::fixed << std::setprecision(1)
+		<< std::setw(8) << ns << " ns/search";
+	return checksum;
+}
+
+void benchmark(const size_t len)
+{
+	// Distinct sorted keys with random gaps, so that about a third of the queries are found.
+	std::mt19937 gen(len);
+	std::vector<int> numbers(len);
+	for(size_t I = 0; I < len; ++I)
+		numbers[I] = 3 * I + gen() % 3;
+
+	std::vector<int> queries(num_queries);
+	for(int& x: queries)
+		x = gen() % (3 * len + 2) - 1;
+
+	EytzingerArray index(numbers);
+
+	std::cout << "\n\n" << len << " ints (" << len * sizeof(int) / 1024 << " KB)";
+
+	const long long found1 = time_test([&](const int x) { return std::binary_search(numbers.begin(), numbers.end(), x); }, queries, "std::binary_search");
+	const long long found2 = time_test([&](const int x) { return index.contains(x); }, queries, "EytzingerArray::contains");
+	const long long pos1 = time_test([&](const int x) { return std::lower_bound(numbers.begin(), numbers.end(), x) - numbers.begin(); }, queries, "std::lower_bound");
+	const long long pos2 = time_test([&](const int x) { return index.lower_bound(x); }, queries, "EytzingerArray::lower_bound");
+
+	if(found1 != found2 || pos1 != pos2)
+	{
+		std::cout << "\nEytzingerArray results differ from std" << std::endl;
+		exit(1);
+	}
+}
+
+// Checks every position of small arrays, including those whose last tree level is partial.
+void validate()
+{
+	for(size_t len = 0; len <= 300; ++len)
+	{
+		std::vector<int> numbers(len);
+		for(size_t I = 0; I < len; ++I)
+			numbers[I] = 2 * (I / 3);	// duplicates: lower_bound must return the first one
+
+		EytzingerArray index(numbers);
+		for(int x = -1; x <= int(len); ++x)
+		{
+			const size_t expected = std::lower_bound(numbers.begin(), numbers.end(), x) - numbers.begin();
+			if(index.lower_bound(x) != expected || index.contains(x) != std::binary_search(numbers.begin(), numbers.end(), x))
+			{
+				std::cout << "\nEytzingerArray lower_bound(" << x << ") wrong for " << len << " keys" << std::endl;
+				exit(1);
+			}
+		}
+	}
+
+	std::cout << "Validation for EytzingerArray successful";
+}
+
+int main(int argc, char* argv[])
+{
+	const int max_log2 = argc > 1 ? atoi(argv[1]) : 26;
+
+	validate();
+	for(int lg = 10; lg <= max_log2; lg += 2)
+		benchmark(size_t(1) << lg);
+
+	std::cout << std::endl;
+	return 0;
+}
@@ -0,0 +1,279 @@
+/* Allocators for DynamicArray.
+*
+* MonotonicArena hands out memory by bumping a pointer inside large blocks and frees everything at
+* once in release(); it suits arrays whose lifetime ends with a request.
+* SizeClassPool keeps a free list per power-of-two size class so that memory freed by one short
+* lived array is reused by the next one without going to the global heap.
+*
+* ArenaAllocator<T> and PoolAllocator<T> adapt them to the std::allocator interface, e.g.
+*
+*	MonotonicArena arena;
+*	DynamicArray<int, ArenaAllocator<int>> arr{ArenaAllocator<int>(arena)};
+*
+* Neither resource is thread safe; use one per thread or per request.
+*/
+#ifndef Allocators_H
+#define Allocators_H
+
+#include <assert.h>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+class MonotonicArena
+{
+	struct Block
+	{
+		Block* next;
+		size_t size;
+	};
+
+	Block* _head = nullptr;
+	char* _cur = nullptr;
+	char* _end = nullptr;
+	size_t _next_block_size;
+
+	public:
+
+	explicit MonotonicArena(const size_t initial_block_size = 64 * 1024): _next_block_size(initial_block_size) {}
+
+	MonotonicArena(const MonotonicArena&) = delete;
+	MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+	~MonotonicArena()
+	{
+		free_blocks(nullptr);
+	}
+
+	void* allocate(const size_t bytes, const size_t alignment)
+	{
+		char* p = align_up(_cur, alignment);
+		if(p == nullptr || p > _end || bytes > static_cast<size_t>(_end - p))
+		{
+			add_block(bytes + alignment);
+			p = align_up(_cur, alignment);
+		}
+
+		_cur = p + bytes;
+		return p;
+	}
+
+	// Makes all the memory handed out so far available again. The most recent (largest) block is
+	// kept, so a steady request-scoped workload stops allocating from the global heap.
+	void release()
+	{
+		if(_head == nullptr)
+			return;
+
+		free_blocks(_head);
+		_head->next = nullptr;
+		_cur = reinterpret_cast<char*>(_head + 1);
+		_end = reinterpret_cast<char*>(_head) + _head->size;
+	}
+
+	private:
+
+	static char* align_up(char* p, const size_t alignment)
+	{
+		const uintptr_t mask = alignment - 1;
+		return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + mask) & ~mask);
+	}
+
+	// Blocks grow geometrically so the number of blocks stays logarithmic in the total size.
+	void add_block(const size_t min_bytes)
+	{
+		size_t size = _next_block_size;
+		while(size < min_bytes + sizeof(Block))
+			size *= 2;
+		_next_block_size = size * 2;
+
+		Block* block = static_cast<Block*>(::operator new(size));
+		block->next = _head;
+		block->size = size;
+		_head = block;
+
+		_cur = reinterpret_cast<char*>(block + 1);
+		_end = reinterpret_cast<char*>(block) + size;
+	}
+
+	// Frees every block after keep; frees all of them when keep is nullptr.
+	void free_blocks(Block* keep)
+	{
+		Block* block = keep != nullptr ? keep->next : _head;
+		while(block != nullptr)
+		{
+			Block* next = block->next;
+			::operator delete(block);
+			block = next;
+		}
+	}
+};
+
+class SizeClassPool
+{
+	static constexpr size_t min_class_bits = 4;	// 16 bytes
+	static constexpr size_t max_class_bits = 12;	// 4 KB
+	static constexpr size_t num_classes = max_class_bits - min_class_bits + 1;
+
+	struct FreeNode
+	{
+		FreeNode* next;
+	};
+
+	FreeNode* _free[num_classes] = {};
+	std::vector<void*> _slabs;
+	size_t _slab_size;
+
+	public:
+
+	explicit SizeClassPool(const size_t slab_size = 64 * 1024): _slab_size(slab_size)
+	{
+		assert(_slab_size >= (size_t(1) << max_class_bits));
+	}
+
+	SizeClassPool(const SizeClassPool&) = delete;
+	SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+	~SizeClassPool()
+	{
+		for(void* slab: _slabs)
+			::operator delete(slab);
+	}
+
+	// Requests larger than the biggest class or with extended alignment go to the global heap.
+	void* allocate(const size_t bytes, const size_t alignment)
+	{
+		if(!pooled(bytes, alignment))
+			return ::operator new(bytes, std::align_val_t(alignment));
+
+		const size_t cls = size_class(bytes);
+		if(_free[cls] == nullptr)
+			refill(cls);
+
+		FreeNode* node = _free[cls];
+		_free[cls] = node->next;
+		return node;
+	}
+
+	void deallocate(void* p, const size_t bytes, const size_t alignment)
+	{
+		if(!pooled(bytes, alignment))
+		{
+			::operator delete(p, std::align_val_t(alignment));
+			return;
+		}
+
+		const size_t cls = size_class(bytes);
+		FreeNode* node = static_cast<FreeNode*>(p);
+		node->next = _free[cls];
+		_free[cls] = node;
+	}
+
+	private:
+
+	static bool pooled(const size_t bytes, const size_t alignment)
+	{
+		return bytes <= (size_t(1) << max_class_bits) && alignment <= alignof(std::max_align_t);
+	}
+
+	static size_t size_class(const size_t bytes)
+	{
+		const size_t bits = bytes <= (size_t(1) << min_class_bits) ? min_class_bits : std::bit_width(bytes - 1);
+		return bits - min_class_bits;
+	}
+
+	// Carves a new slab into blocks of the given class and pushes them on its free list.
+	void refill(const size_t cls)
+	{
+		const size_t block_size = size_t(1) << (cls + min_class_bits);
+		char* slab = static_cast<char*>(::operator new(_slab_size));
+		_slabs.push_back(slab);
+
+		for(size_t offset = 0; offset + block_size <= _slab_size; offset += block_size)
+		{
+			FreeNode* node = reinterpret_cast<FreeNode*>(slab + offset);
+			node->next = _free[cls];
+			_free[cls] = node;
+		}
+	}
+};
+
+template<class T>
+class ArenaAllocator
+{
+	MonotonicArena* _arena;
+
+	public:
+
+	using value_type = T;
+
+	ArenaAllocator(MonotonicArena& arena): _arena(&arena) {}
+
+	template<class U>
+	ArenaAllocator(const ArenaAllocator<U>& other): _arena(other.arena()) {}
+
+	MonotonicArena* arena() const
+	{
+		return _arena;
+	}
+
+	T* allocate(const size_t n)
+	{
+		if(n > size_t(-1) / sizeof(T))
+			throw std::bad_array_new_length();
+
+		return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	// Memory is reclaimed only by MonotonicArena::release.
+	void deallocate(T*, const size_t) {}
+
+	template<class U>
+	bool operator==(const ArenaAllocator<U>& other) const
+	{
+		return _arena == other.arena();
+	}
+};
+
+template<class T>
+class PoolAllocator
+{
+	SizeClassPool* _pool;
+
+	public:
+
+	using value_type = T;
+
+	PoolAllocator(SizeClassPool& pool): _pool(&pool) {}
+
+	template<class U>
+	PoolAllocator(const PoolAllocator<U>& other): _pool(other.pool()) {}
+
+	SizeClassPool* pool() const
+	{
+		return _pool;
+	}
+
+	T* allocate(const size_t n)
+	{
+		if(n > size_t(-1) / sizeof(T))
+			throw std::bad_array_new_length();
+
+		return static_cast<T*>(_pool->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* p, const size_t n)
+	{
+		_pool->deallocate(p, n * sizeof(T), alignof(T));
+	}
+
+	template<class U>
+	bool operator==(const PoolAllocator<U>& other) const
+	{
+		return _pool == other.pool();
+	}
+};
+
+#endif
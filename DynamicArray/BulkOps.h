@@ -0,0 +1,317 @@
+/* Vectorized bulk operations on contiguous arrays of arithmetic types.
+*
+* bulk_sum, bulk_min, bulk_max, bulk_fill and bulk_scaled_add work on a pointer and a length, and on
+* DynamicArray directly. Each kernel is written once with GCC/Clang vector extensions and compiled
+* for AVX2 (256-bit), for the SSE2 baseline (128-bit) and as a plain scalar loop; the variant is
+* chosen at run time from the CPU features, see bulk_simd_level.
+*
+* Vector sums of floating point values are reassociated, so they may differ from a sequential
+* std::accumulate in the last bits. Integer sums wrap around like unsigned arithmetic.
+*/
+#ifndef BulkOps_H
+#define BulkOps_H
+
+#include <assert.h>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "DynamicArray.h"
+#include "../Platform.h"
+
+// Kernel variant used by the bulk_* functions; may be lowered (e.g. to benchmark the scalar loops).
+inline SimdLevel bulk_simd_level = detect_simd_level();
+
+template<class T>
+concept BulkArithmetic = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// Integer sums are computed in the unsigned type so that overflow wraps instead of being undefined.
+template<class T>
+using BulkSumType = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, std::type_identity<T>>::type;
+
+template<class T>
+struct ScalarBulk
+{
+	static T sum(const T* p, const size_t n)
+	{
+		using S = BulkSumType<T>;
+		S s = 0;
+		for(size_t I = 0; I < n; ++I)
+			s += static_cast<S>(p[I]);
+		return static_cast<T>(s);
+	}
+
+	template<bool IsMin>
+	static bool better(const T a, const T b)
+	{
+		return IsMin ? a < b : a > b;
+	}
+
+	template<bool IsMin>
+	static T extreme(const T* p, const size_t n)
+	{
+		T m = p[0];
+		for(size_t I = 1; I < n; ++I)
+			m = better<IsMin>(p[I], m) ? p[I] : m;
+		return m;
+	}
+
+	static void fill(T* p, const size_t n, const T value)
+	{
+		for(size_t I = 0; I < n; ++I)
+			p[I] = value;
+	}
+
+	static void scaled_add(T* y, const T a, const T* x, const size_t n)
+	{
+		for(size_t I = 0; I < n; ++I)
+			y[I] += a * x[I];
+	}
+};
+
+// The kernels pass vectors by value only between always_inline functions, so the ABI note
+// about 256-bit vectors without AVX enabled does not apply.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template<class T, size_t Bytes>
+struct BulkKernels
+{
+	typedef T V __attribute__((vector_size(Bytes)));
+	static constexpr size_t lanes = Bytes / sizeof(T);
+
+	[[gnu::always_inline]] static inline V load(const T* p)
+	{
+		V v;
+		std::memcpy(&v, p, sizeof(V));
+		return v;
+	}
+
+	[[gnu::always_inline]] static inline void store(T* p, const V& v)
+	{
+		std::memcpy(p, &v, sizeof(V));
+	}
+
+	// Four independent accumulators hide the latency of the vector adds.
+	[[gnu::always_inline]] static inline T sum(const T* p, const size_t n)
+	{
+		V acc0{}, acc1{}, acc2{}, acc3{};
+		size_t I = 0;
+		for(; I + 4 * lanes <= n; I += 4 * lanes)
+		{
+			acc0 += load(p + I);
+			acc1 += load(p + I + lanes);
+			acc2 += load(p + I + 2 * lanes);
+			acc3 += load(p + I + 3 * lanes);
+		}
+		for(; I + lanes <= n; I += lanes)
+			acc0 += load(p + I);
+
+		acc0 = (acc0 + acc1) + (acc2 + acc3);
+		T s = 0;
+		for(size_t J = 0; J < lanes; ++J)
+			s += acc0[J];
+		for(; I < n; ++I)
+			s += p[I];
+
+		return s;
+	}
+
+	template<bool IsMin>
+	[[gnu::always_inline]] static inline T extreme(const T* p, const size_t n)
+	{
+		assert(n > 0);
+		if(n < lanes)
+			return ScalarBulk<T>::template extreme<IsMin>(p, n);
+
+		V acc = load(p);
+		size_t I = lanes;
+		for(; I + lanes <= n; I += lanes)
+		{
+			const V v = load(p + I);
+			acc = IsMin ? (v < acc ? v : acc) : (v > acc ? v : acc);
+		}
+
+		T m = acc[0];
+		for(size_t J = 1; J < lanes; ++J)
+			m = ScalarBulk<T>::template better<IsMin>(acc[J], m) ? acc[J] : m;
+		for(; I < n; ++I)
+			m = ScalarBulk<T>::template better<IsMin>(p[I], m) ? p[I] : m;
+
+		return m;
+	}
+
+	[[gnu::always_inline]] static inline void fill(T* p, const size_t n, const T value)
+	{
+		const V v = V{} + value;
+		size_t I = 0;
+		for(; I + lanes <= n; I += lanes)
+			store(p + I, v);
+		for(; I < n; ++I)
+			p[I] = value;
+	}
+
+	// y[i] += a * x[i]
+	[[gnu::always_inline]] static inline void scaled_add(T* y, const T a, const T* x, const size_t n)
+	{
+		size_t I = 0;
+		for(; I + lanes <= n; I += lanes)
+			store(y + I, load(y + I) + a * load(x + I));
+		for(; I < n; ++I)
+			y[I] += a * x[I];
+	}
+};
+
+#pragma GCC diagnostic pop
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The kernels are inlined into these functions and therefore compiled with their target options.
+template<class T, size_t Bytes>
+struct TargetBulk;
+
+template<class T>
+struct TargetBulk<T, 32>
+{
+	using K = BulkKernels<BulkSumType<T>, 32>;
+	using M = BulkKernels<T, 32>;
+
+	[[gnu::target("avx2")]] static T sum(const T* p, const size_t n)
+	{
+		return static_cast<T>(K::sum(reinterpret_cast<const BulkSumType<T>*>(p), n));
+	}
+
+	template<bool IsMin>
+	[[gnu::target("avx2")]] static T extreme(const T* p, const size_t n)
+	{
+		return M::template extreme<IsMin>(p, n);
+	}
+
+	[[gnu::target("avx2")]] static void fill(T* p, const size_t n, const T value)
+	{
+		M::fill(p, n, value);
+	}
+
+	[[gnu::target("avx2")]] static void scaled_add(T* y, const T a, const T* x, const size_t n)
+	{
+		M::scaled_add(y, a, x, n);
+	}
+};
+
+template<class T>
+struct TargetBulk<T, 16>
+{
+	using K = BulkKernels<BulkSumType<T>, 16>;
+	using M = BulkKernels<T, 16>;
+
+	[[gnu::target("sse2")]] static T sum(const T* p, const size_t n)
+	{
+		return static_cast<T>(K::sum(reinterpret_cast<const BulkSumType<T>*>(p), n));
+	}
+
+	template<bool IsMin>
+	[[gnu::target("sse2")]] static T extreme(const T* p, const size_t n)
+	{
+		return M::template extreme<IsMin>(p, n);
+	}
+
+	[[gnu::target("sse2")]] static void fill(T* p, const size_t n, const T value)
+	{
+		M::fill(p, n, value);
+	}
+
+	[[gnu::target("sse2")]] static void scaled_add(T* y, const T a, const T* x, const size_t n)
+	{
+		M::scaled_add(y, a, x, n);
+	}
+};
+
+// Calls fn with the kernel set selected by bulk_simd_level.
+template<class T, class Fn>
+decltype(auto) bulk_dispatch(Fn fn)
+{
+	switch(bulk_simd_level)
+	{
+		case SimdLevel::AVX2:
+			return fn(TargetBulk<T, 32>());
+		case SimdLevel::SSE2:
+			return fn(TargetBulk<T, 16>());
+		default:
+			return fn(ScalarBulk<T>());
+	}
+}
+
+#else
+
+template<class T, class Fn>
+decltype(auto) bulk_dispatch(Fn fn)
+{
+	return fn(ScalarBulk<T>());
+}
+
+#endif
+
+template<BulkArithmetic T>
+T bulk_sum(const T* p, const size_t n)
+{
+	return bulk_dispatch<T>([&](auto kernels) { return kernels.sum(p, n); });
+}
+
+template<BulkArithmetic T>
+T bulk_min(const T* p, const size_t n)
+{
+	assert(n > 0);
+	return bulk_dispatch<T>([&](auto kernels) { return kernels.template extreme<true>(p, n); });
+}
+
+template<BulkArithmetic T>
+T bulk_max(const T* p, const size_t n)
+{
+	assert(n > 0);
+	return bulk_dispatch<T>([&](auto kernels) { return kernels.template extreme<false>(p, n); });
+}
+
+template<BulkArithmetic T>
+void bulk_fill(T* p, const size_t n, const T value)
+{
+	bulk_dispatch<T>([&](auto kernels) { kernels.fill(p, n, value); });
+}
+
+// y[i] += a * x[i] for i in [0, n)
+template<BulkArithmetic T>
+void bulk_scaled_add(T* y, const T a, const T* x, const size_t n)
+{
+	bulk_dispatch<T>([&](auto kernels) { kernels.scaled_add(y, a, x, n); });
+}
+
+template<BulkArithmetic T, class Allocator, size_t N>
+T bulk_sum(const DynamicArray<T, Allocator, N>& arr)
+{
+	return bulk_sum(arr.data(), arr.size());
+}
+
+template<BulkArithmetic T, class Allocator, size_t N>
+T bulk_min(const DynamicArray<T, Allocator, N>& arr)
+{
+	return bulk_min(arr.data(), arr.size());
+}
+
+template<BulkArithmetic T, class Allocator, size_t N>
+T bulk_max(const DynamicArray<T, Allocator, N>& arr)
+{
+	return bulk_max(arr.data(), arr.size());
+}
+
+template<BulkArithmetic T, class Allocator, size_t N>
+void bulk_fill(DynamicArray<T, Allocator, N>& arr, const T value)
+{
+	bulk_fill(arr.data(), arr.size(), value);
+}
+
+template<BulkArithmetic T, class Allocator, size_t N, class XAllocator, size_t XN>
+void bulk_scaled_add(DynamicArray<T, Allocator, N>& y, const T a, const DynamicArray<T, XAllocator, XN>& x)
+{
+	assert(y.size() == x.size());
+	bulk_scaled_add(y.data(), a, x.data(), y.size());
+}
+
+#endif
@@ -0,0 +1,313 @@
+/* Segmented dynamic array that never relocates its elements.
+*
+* Elements are stored in chunks of 2^ChunkBits elements and a DynamicArray of chunk pointers maps
+* index i to chunks[i >> ChunkBits][i & mask]. Growing allocates one more chunk and at most copies the
+* pointer table, so append latency stays flat however large the array gets, and references to
+* existing elements stay valid across appends. The pointer table itself does move when it grows,
+* so an Iterator holds the array and an index rather than the table; iterators stay valid across
+* appends too, but not across moving the array.
+*/
+#ifndef ChunkedDynamicArray_H
+#define ChunkedDynamicArray_H
+
+#include <assert.h>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <utility>
+#include "DynamicArray.h"
+
+template<class T, size_t ChunkBits = 12, class Allocator = std::allocator<T>>
+class ChunkedDynamicArray
+{
+	using alloc_traits = std::allocator_traits<Allocator>;
+	using ChunkTable = DynamicArray<T*, typename alloc_traits::template rebind_alloc<T*>>;
+
+	static constexpr size_t chunk_size = size_t(1) << ChunkBits;
+	static constexpr size_t chunk_mask = chunk_size - 1;
+
+	[[no_unique_address]] Allocator _alloc;
+	ChunkTable _chunks;
+	size_t _size = 0;
+
+	public:
+
+	// Iterator over E: T for Iterator, const T for ConstIterator.
+	template<class E>
+	class BasicIterator
+	{
+		const ChunkedDynamicArray* _arr = nullptr;
+		size_t _index = 0;
+
+		template<class> friend class BasicIterator;
+
+		public:
+
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = E*;
+		using reference = E&;
+		using iterator_category = std::random_access_iterator_tag;
+
+		BasicIterator() {}
+
+		BasicIterator(const ChunkedDynamicArray* arr, const size_t index): _arr(arr), _index(index) {}
+
+		// An Iterator converts to a ConstIterator, not the other way around.
+		template<class U>
+		requires std::same_as<E, const U>
+		BasicIterator(const BasicIterator<U>& itr): _arr(itr._arr), _index(itr._index) {}
+
+		E& operator*() const
+		{
+			return _arr->_chunks[_index >> ChunkBits][_index & chunk_mask];
+		}
+
+		E* operator->() const
+		{
+			return &**this;
+		}
+
+		E& operator[](const difference_type index) const
+		{
+			return *(*this + index);
+		}
+
+		BasicIterator& operator++()
+		{
+			++_index;
+			return *this;
+		}
+
+		BasicIterator operator++(int)
+		{
+			const BasicIterator old = *this;
+			++_index;
+			return old;
+		}
+
+		BasicIterator& operator--()
+		{
+			--_index;
+			return *this;
+		}
+
+		BasicIterator operator--(int)
+		{
+			const BasicIterator old = *this;
+			--_index;
+			return old;
+		}
+
+		BasicIterator operator+(const difference_type sz) const
+		{
+			return BasicIterator(_arr, _index + sz);
+		}
+
+		friend BasicIterator operator+(const difference_type sz, const BasicIterator& itr)
+		{
+			return itr + sz;
+		}
+
+		BasicIterator operator-(const difference_type sz) const
+		{
+			return BasicIterator(_arr, _index - sz);
+		}
+
+		difference_type operator-(const BasicIterator& itr) const
+		{
+			return static_cast<difference_type>(_index) - static_cast<difference_type>(itr._index);
+		}
+
+		BasicIterator& operator+=(const difference_type sz)
+		{
+			_index += sz;
+			return *this;
+		}
+
+		BasicIterator& operator-=(const difference_type sz)
+		{
+			_index -= sz;
+			return *this;
+		}
+
+		bool operator==(const BasicIterator& itr) const
+		{
+			return _index == itr._index;
+		}
+
+		auto operator<=>(const BasicIterator& itr) const
+		{
+			return _index <=> itr._index;
+		}
+	};
+
+	using Iterator = BasicIterator<T>;
+	using ConstIterator = BasicIterator<const T>;
+
+	ChunkedDynamicArray(const Allocator& alloc = Allocator()): _alloc(alloc), _chunks(typename alloc_traits::template rebind_alloc<T*>(alloc)) {}
+
+	ChunkedDynamicArray(std::initializer_list<T> lst, const Allocator& alloc = Allocator()): ChunkedDynamicArray(alloc)
+	{
+		append(lst);
+	}
+
+	ChunkedDynamicArray(const ChunkedDynamicArray& iarr): ChunkedDynamicArray(alloc_traits::select_on_container_copy_construction(iarr._alloc))
+	{
+		for(size_t I = 0; I < iarr._size; ++I)
+			push_back(iarr[I]);
+	}
+
+	ChunkedDynamicArray(ChunkedDynamicArray&& iarr): _alloc(std::move(iarr._alloc)), _chunks(std::move(iarr._chunks)), _size(iarr._size)
+	{
+		iarr._size = 0;
+	}
+
+	ChunkedDynamicArray& operator=(ChunkedDynamicArray iarr)
+	{
+		clear();
+		release_chunks();
+		std::swap(_alloc, iarr._alloc);
+		std::swap(_chunks, iarr._chunks);
+		std::swap(_size, iarr._size);
+		return *this;
+	}
+
+	~ChunkedDynamicArray()
+	{
+		clear();
+		release_chunks();
+	}
+
+	Iterator begin()
+	{
+		return Iterator(this, 0);
+	}
+
+	Iterator end()
+	{
+		return Iterator(this, _size);
+	}
+
+	ConstIterator begin() const
+	{
+		return ConstIterator(this, 0);
+	}
+
+	ConstIterator end() const
+	{
+		return ConstIterator(this, _size);
+	}
+
+	size_t size() const
+	{
+		return _size;
+	}
+
+	bool empty() const
+	{
+		return _size == 0;
+	}
+
+	size_t capacity() const
+	{
+		return _chunks.size() * chunk_size;
+	}
+
+	const T& operator[](const size_t index) const
+	{
+		assert(index < _size);
+		return _chunks[index >> ChunkBits][index & chunk_mask];
+	}
+
+	T& operator[](const size_t index)
+	{
+		assert(index < _size);
+		return _chunks[index >> ChunkBits][index & chunk_mask];
+	}
+
+	T& back()
+	{
+		assert(_size > 0);
+		return (*this)[_size-1];
+	}
+
+	template<class... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if(_size == capacity())
+			_chunks.push_back(alloc_traits::allocate(_alloc, chunk_size));
+
+		T* p = &_chunks[_size >> ChunkBits][_size & chunk_mask];
+		alloc_traits::construct(_alloc, p, std::forward<Args>(args)...);
+		++_size;
+		return *p;
+	}
+
+	void push_back(const T& t)
+	{
+		emplace_back(t);
+	}
+
+	void push_back(T&& t)
+	{
+		emplace_back(std::move(t));
+	}
+
+	void pop_back()
+	{
+		assert(_size > 0);
+		--_size;
+		alloc_traits::destroy(_alloc, &_chunks[_size >> ChunkBits][_size & chunk_mask]);
+	}
+
+	void append(std::initializer_list<T> lst)
+	{
+		append(lst.begin(), lst.size());
+	}
+
+	void append(std::span<const T> ispan)
+	{
+		append(ispan.data(), ispan.size());
+	}
+
+	void append(const T* idata, const size_t sz)
+	{
+		for(size_t I = 0; I < sz; ++I)
+			push_back(idata[I]);
+	}
+
+	// Destroys the elements; the chunks are kept for reuse.
+	void clear()
+	{
+		for(size_t I = 0; I < _size; ++I)
+			alloc_traits::destroy(_alloc, &_chunks[I >> ChunkBits][I & chunk_mask]);
+		_size = 0;
+	}
+
+	// Frees the chunks beyond the one holding the last element.
+	void shrink_to_fit()
+	{
+		const size_t used = (_size + chunk_mask) >> ChunkBits;
+		while(_chunks.size() > used)
+		{
+			alloc_traits::deallocate(_alloc, _chunks.back(), chunk_size);
+			_chunks.pop_back();
+		}
+		_chunks.shrink_to_fit();
+	}
+
+	private:
+
+	void release_chunks()
+	{
+		for(size_t I = 0; I < _chunks.size(); ++I)
+			alloc_traits::deallocate(_alloc, _chunks[I], chunk_size);
+		_chunks.clear();
+	}
+};
+
+#endif
@@ -0,0 +1,296 @@
+/* Append-only dynamic array for many concurrent producers and lock-free readers.
+*
+* Producers reserve indices with a single atomic fetch_add and construct their elements in place;
+* nothing is ever relocated. Storage is a fixed table of segments whose sizes double (the first one
+* holds 2^FirstSegmentBits elements), so index -> (segment, offset) is a couple of bit operations
+* and a segment is allocated by whichever producer first needs it.
+*
+* Every slot carries a ready flag set with release ordering once its element is constructed.
+* published_size() returns the length of the prefix whose elements are all ready; readers may access
+* any index below it, or iterate the prefix with begin()/end(), without taking a lock.
+*
+* Elements are destroyed by the destructor, which must not run concurrently with producers.
+*/
+#ifndef ConcurrentDynamicArray_H
+#define ConcurrentDynamicArray_H
+
+#include <assert.h>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <span>
+#include <utility>
+
+template<class T, size_t FirstSegmentBits = 10>
+class ConcurrentDynamicArray
+{
+	static constexpr size_t max_segments = 8 * sizeof(size_t) - FirstSegmentBits;
+
+	struct Slot
+	{
+		std::atomic<bool> ready{false};
+		alignas(T) unsigned char storage[sizeof(T)];
+
+		T* get()
+		{
+			return std::launder(reinterpret_cast<T*>(storage));
+		}
+	};
+
+	std::atomic<Slot*> _segments[max_segments] = {};
+	std::atomic<size_t> _reserved{0};
+	std::atomic<size_t> _published{0};
+
+	public:
+
+	class Iterator
+	{
+		ConcurrentDynamicArray* _arr = nullptr;
+		size_t _index = 0;
+
+		public:
+
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T*;
+		using reference = T&;
+		using iterator_category = std::random_access_iterator_tag;
+
+		Iterator() {}
+
+		Iterator(ConcurrentDynamicArray* arr, const size_t index): _arr(arr), _index(index) {}
+
+		T& operator*() const
+		{
+			return (*_arr)[_index];
+		}
+
+		T* operator->() const
+		{
+			return &(*_arr)[_index];
+		}
+
+		T& operator[](const difference_type index) const
+		{
+			return (*_arr)[_index + index];
+		}
+
+		Iterator& operator++()
+		{
+			++_index;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			const Iterator old = *this;
+			++_index;
+			return old;
+		}
+
+		Iterator& operator--()
+		{
+			--_index;
+			return *this;
+		}
+
+		Iterator operator--(int)
+		{
+			const Iterator old = *this;
+			--_index;
+			return old;
+		}
+
+		Iterator operator+(const difference_type sz) const
+		{
+			return Iterator(_arr, _index + sz);
+		}
+
+		friend Iterator operator+(const difference_type sz, const Iterator& itr)
+		{
+			return itr + sz;
+		}
+
+		Iterator operator-(const difference_type sz) const
+		{
+			return Iterator(_arr, _index - sz);
+		}
+
+		difference_type operator-(const Iterator& itr) const
+		{
+			return static_cast<difference_type>(_index) - static_cast<difference_type>(itr._index);
+		}
+
+		Iterator& operator+=(const difference_type sz)
+		{
+			_index += sz;
+			return *this;
+		}
+
+		Iterator& operator-=(const difference_type sz)
+		{
+			_index -= sz;
+			return *this;
+		}
+
+		bool operator==(const Iterator& itr) const
+		{
+			return _index == itr._index;
+		}
+
+		auto operator<=>(const Iterator& itr) const
+		{
+			return _index <=> itr._index;
+		}
+	};
+
+	ConcurrentDynamicArray() {}
+
+	ConcurrentDynamicArray(const ConcurrentDynamicArray&) = delete;
+	ConcurrentDynamicArray& operator=(const ConcurrentDynamicArray&) = delete;
+
+	~ConcurrentDynamicArray()
+	{
+		const size_t reserved = _reserved.load(std::memory_order_acquire);
+		for(size_t s = 0; s < max_segments; ++s)
+		{
+			Slot* seg = _segments[s].load(std::memory_order_acquire);
+			if(seg == nullptr)
+				continue;
+
+			const size_t first = segment_start(s);
+			for(size_t I = 0; I < segment_size(s) && first + I < reserved; ++I)
+				if(seg[I].ready.load(std::memory_order_relaxed))
+					seg[I].get()->~T();
+
+			delete[] seg;
+		}
+	}
+
+	// Begin/end of the published prefix at the time end() is called.
+	Iterator begin()
+	{
+		return Iterator(this, 0);
+	}
+
+	Iterator end()
+	{
+		return Iterator(this, published_size());
+	}
+
+	// Constructs an element in a freshly reserved slot and returns its index.
+	template<class... Args>
+	size_t emplace_back(Args&&... args)
+	{
+		const size_t index = _reserved.fetch_add(1, std::memory_order_relaxed);
+		Slot& slot = slot_for(index);
+		::new(static_cast<void*>(slot.storage)) T(std::forward<Args>(args)...);
+		slot.ready.store(true, std::memory_order_release);
+		return index;
+	}
+
+	size_t push_back(const T& t)
+	{
+		return emplace_back(t);
+	}
+
+	size_t push_back(T&& t)
+	{
+		return emplace_back(std::move(t));
+	}
+
+	// Reserves a contiguous range of indices with one atomic operation, copies the elements into it
+	// and returns the first index.
+	size_t append(std::span<const T> ispan)
+	{
+		const size_t first = _reserved.fetch_add(ispan.size(), std::memory_order_relaxed);
+		for(size_t I = 0; I < ispan.size(); ++I)
+		{
+			Slot& slot = slot_for(first + I);
+			::new(static_cast<void*>(slot.storage)) T(ispan[I]);
+			slot.ready.store(true, std::memory_order_release);
+		}
+
+		return first;
+	}
+
+	// Number of indices handed out to producers; some of them may still be under construction.
+	size_t reserved_size() const
+	{
+		return _reserved.load(std::memory_order_acquire);
+	}
+
+	// Length of the longest prefix whose elements are all constructed. It only grows, and every
+	// element below it is visible to the calling thread.
+	size_t published_size()
+	{
+		const size_t start = _published.load(std::memory_order_acquire);
+		const size_t reserved = _reserved.load(std::memory_order_acquire);
+
+		size_t end = start;
+		while(end < reserved && is_ready(end))
+			++end;
+
+		size_t current = start;
+		while(current < end && !_published.compare_exchange_weak(current, end, std::memory_order_release, std::memory_order_acquire)) {}
+
+		return current > end ? current : end;
+	}
+
+	// The element must be published, i.e. index < published_size() observed by this thread.
+	T& operator[](const size_t index)
+	{
+		assert(index < _reserved.load(std::memory_order_relaxed));
+		const size_t s = segment_of(index);
+		Slot* seg = _segments[s].load(std::memory_order_acquire);
+		return *seg[index - segment_start(s)].get();
+	}
+
+	private:
+
+	// Segment s holds indices [B * (2^s - 1), B * (2^(s+1) - 1)) where B = 2^FirstSegmentBits.
+	static size_t segment_of(const size_t index)
+	{
+		return std::bit_width((index >> FirstSegmentBits) + 1) - 1;
+	}
+
+	static size_t segment_start(const size_t s)
+	{
+		return ((size_t(1) << s) - 1) << FirstSegmentBits;
+	}
+
+	static size_t segment_size(const size_t s)
+	{
+		return size_t(1) << (s + FirstSegmentBits);
+	}
+
+	bool is_ready(const size_t index)
+	{
+		const size_t s = segment_of(index);
+		Slot* seg = _segments[s].load(std::memory_order_acquire);
+		return seg != nullptr && seg[index - segment_start(s)].ready.load(std::memory_order_acquire);
+	}
+
+	// Allocates the segment on first use; when producers race, the loser frees its copy.
+	Slot& slot_for(const size_t index)
+	{
+		const size_t s = segment_of(index);
+		assert(s < max_segments);
+
+		Slot* seg = _segments[s].load(std::memory_order_acquire);
+		if(seg == nullptr)
+		{
+			Slot* fresh = new Slot[segment_size(s)];
+			if(_segments[s].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+				seg = fresh;
+			else
+				delete[] fresh;
+		}
+
+		return seg[index - segment_start(s)];
+	}
+};
+
+#endif
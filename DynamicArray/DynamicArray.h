@@ -4,214 +4,400 @@
 *
 * Dynamic array data-structure with iterators using templates. 
 * 
+* Storage is obtained from the Allocator (std::allocator by default, see Allocators.h for
+* arena and pool allocators); only the elements in [0, size) are constructed, so reserved
+* capacity costs nothing and T does not need to be default constructible.
+*
+* With InlineCapacity > 0 (see SmallDynamicArray) the first InlineCapacity elements are stored
+* inside the object itself and the heap is used only once the array grows beyond that.
 */ 
+#ifndef DynamicArray_H
+#define DynamicArray_H
+
 #include <assert.h>
 #include <array>
+#include <concepts>
+#include <cstring>
 #include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+template<class T, size_t N>
+struct InlineStorage
+{
+	alignas(T) unsigned char _bytes[N * sizeof(T)];
+
+	T* data()
+	{
+		return reinterpret_cast<T*>(_bytes);
+	}
+};
 
 template<class T>
+struct InlineStorage<T, 0>
+{
+	T* data()
+	{
+		return nullptr;
+	}
+};
+
+template<class T, class Allocator = std::allocator<T>, size_t InlineCapacity = 0>
 class DynamicArray
 {
+	using alloc_traits = std::allocator_traits<Allocator>;
+
+	// Moving an array moves its inline elements one by one; a heap buffer is just stolen.
+	static constexpr bool nothrow_inline_move = InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>;
+
+	[[no_unique_address]] Allocator _alloc;
+	[[no_unique_address]] InlineStorage<T, InlineCapacity> _inline;
 	size_t _size=0;
-	size_t _capacity=0;
-	T * _data = nullptr;
+	size_t _capacity=InlineCapacity;
+	double _growth_factor = 2.0;
+	T * _data = _inline.data();
 
 	public:
 
-	class Iterator
+	// Iterator over E: T for Iterator, const T for ConstIterator.
+	template<class E>
+	class BasicIterator
 	{
-		T* _pdata;
+		E* _pdata = nullptr;
+
+		template<class> friend class BasicIterator;
 	
 		public:
 		
-		using value_type = T;
+		using value_type = std::remove_const_t<E>;
+		using element_type = E;
 		using difference_type = std::ptrdiff_t;
-		using pointer = T*;
-		using reference = T&;
+		using pointer = E*;
+		using reference = E&;
 		using iterator_category = std::random_access_iterator_tag;
+		using iterator_concept = std::contiguous_iterator_tag;
 
-		Iterator(T* pdata):_pdata(pdata) {}
+		BasicIterator() {}
 
-		const T& operator*() const 
-		{
-			return *_pdata;
-		}
+		BasicIterator(E* pdata):_pdata(pdata) {}
+
+		// An Iterator converts to a ConstIterator, not the other way around.
+		template<class U>
+		requires std::same_as<E, const U>
+		BasicIterator(const BasicIterator<U>& itr):_pdata(itr._pdata) {}
 
-		T& operator*()
+		// Like a pointer, a const Iterator still refers to mutable elements; this keeps
+		// Iterator a std::contiguous_iterator so it can be used to build spans. Read-only access
+		// goes through ConstIterator, which the const begin() and end() return.
+		E& operator*() const
 		{
 			return *_pdata;
 		}
 
-		T* operator->()
+		E* operator->() const
 		{
 			return _pdata;
 		}
 
-		T& operator[](const size_t index)
-		{
-			return *(_pdata+index);
-		}
-	
-		const T& operator[](const size_t index) const 
+		E& operator[](const difference_type index) const
 		{
 			return *(_pdata+index);
 		}
 
-		Iterator& operator++()
+		BasicIterator& operator++()
 		{
 			_pdata++;
 			return *this;
 		}
 
-		Iterator operator++(int)
+		BasicIterator operator++(int)
 		{
-		    const Iterator old(_pdata);
+		    const BasicIterator old(_pdata);
 			++(*this);
 			return old;
 		}
 
-		Iterator& operator--()
+		BasicIterator& operator--()
 		{
 			_pdata--;
 			return *this;
 		}
 
-		Iterator operator--(int)
+		BasicIterator operator--(int)
 		{
-		    const Iterator old(_pdata);
+		    const BasicIterator old(_pdata);
 			--(*this);
 			return old;
 		}
 
-		Iterator operator+(const size_t sz)
+		BasicIterator operator+(const difference_type sz) const
 		{
-			return Iterator(_pdata+sz);
+			return BasicIterator(_pdata+sz);
 		}
 
-		Iterator operator-(const size_t sz)
+		friend BasicIterator operator+(const difference_type sz, const BasicIterator& itr)
 		{
-			return Iterator(_pdata-sz);
+			return BasicIterator(itr._pdata+sz);
 		}
 
-		difference_type operator-(Iterator const& itr)
+		BasicIterator operator-(const difference_type sz) const
+		{
+			return BasicIterator(_pdata-sz);
+		}
+
+		difference_type operator-(BasicIterator const& itr) const
 		{
 			return (_pdata - itr._pdata);
 		}
 
-		Iterator& operator+=(const size_t sz)
+		BasicIterator& operator+=(const difference_type sz)
 		{
 			_pdata+=sz;
 			return *this;
 		}
 
-		Iterator& operator-=(const size_t sz)
+		BasicIterator& operator-=(const difference_type sz)
 		{
 			_pdata-=sz;
 			return *this;
 		}
 
-		bool operator==(const Iterator& itr)
+		bool operator==(const BasicIterator& itr) const
 		{
 			return _pdata == itr._pdata;
 		}
 
-		bool operator!=(const Iterator& itr)
+		bool operator!=(const BasicIterator& itr) const
 		{
 			return _pdata != itr._pdata;
 		}
 
-		bool operator<(const Iterator& itr)
+		bool operator<(const BasicIterator& itr) const
 		{
 			return _pdata < itr._pdata;
 		}
 
-		bool operator>(const Iterator& itr)
+		bool operator>(const BasicIterator& itr) const
 		{
 			return _pdata > itr._pdata;
 		}
 
-		bool operator<=(const Iterator& itr)
+		bool operator<=(const BasicIterator& itr) const
 		{
 			return _pdata <= itr._pdata;
 		}
 
-		bool operator>=(const Iterator& itr)
+		bool operator>=(const BasicIterator& itr) const
 		{
 			return _pdata >= itr._pdata;
 		}
 	};
 
+	using Iterator = BasicIterator<T>;
+	using ConstIterator = BasicIterator<const T>;
+
 	Iterator begin()
 	{
-		return Iterator(&_data[0]);
+		return Iterator(_data);
 	}
 
 	Iterator end()
 	{
-		return Iterator(&_data[_size]);
+		return Iterator(_data + _size);
+	}
+
+	ConstIterator begin() const
+	{
+		return ConstIterator(_data);
+	}
+
+	ConstIterator end() const
+	{
+		return ConstIterator(_data + _size);
 	}
 
 	DynamicArray() {}
 
+	explicit DynamicArray(const Allocator& alloc): _alloc(alloc) {}
+
 	~DynamicArray() 
 	{
-		delete[] _data;
+		destroy(_data, _data + _size);
+		deallocate(_data, _capacity);
 		_size = 0;
 		_capacity = 0;
 	}
 
-
-	DynamicArray(const size_t isize): _size(isize), _capacity(isize)
+	DynamicArray(const size_t isize, const Allocator& alloc = Allocator()): _alloc(alloc), _size(isize)
 	{
-		_data = new T[_size];
+		init_storage(_size);
+		for(size_t I = 0; I < _size; ++I)
+			construct(_data + I);
 	}
 	
-	DynamicArray(const size_t isize, const T& t): DynamicArray(isize)
+	DynamicArray(const size_t isize, const T& t, const Allocator& alloc = Allocator()): _alloc(alloc), _size(isize)
 	{
-		for(int I=0;I<isize;++I)
-			_data[I] = t;
+		init_storage(_size);
+		for(size_t I = 0; I < _size; ++I)
+			construct(_data + I, t);
 	}
 
-	DynamicArray(DynamicArray& idynarr)
+	DynamicArray(const DynamicArray& idynarr): _alloc(alloc_traits::select_on_container_copy_construction(idynarr._alloc))
 	{
 		_size = idynarr._size;
-		_capacity = _size;
-		_data = new T[_size];
-		for(int I=0;I<_size;++I)
-			_data[I] = idynarr._data[I];
+		_growth_factor = idynarr._growth_factor;
+		init_storage(_size);
+		copy_construct(idynarr._data, _size, _data);
 	}
 
-	DynamicArray(DynamicArray&& idynarr)
+	// Inline elements cannot be stolen, they are moved one by one.
+	DynamicArray(DynamicArray&& idynarr) noexcept(nothrow_inline_move): _alloc(std::move(idynarr._alloc))
 	{
 		_size = idynarr._size;
-		_capacity = _size;
-		_data = idynarr._data;
+		_growth_factor = idynarr._growth_factor;
+		if(idynarr.is_inline())
+		{
+			relocate(idynarr._data, _size, _data);
+		}
+		else
+		{
+			_capacity = idynarr._capacity;
+			_data = idynarr._data;
+			idynarr.reset_storage();
+		}
 		idynarr._size = 0;
-		idynarr._capacity = 0;
-		idynarr._data = nullptr;
 	}
 
-	DynamicArray(std::initializer_list<T> lst): DynamicArray(lst.size())
+	DynamicArray(std::initializer_list<T> lst, const Allocator& alloc = Allocator()): _alloc(alloc), _size(lst.size())
+	{
+		init_storage(_size);
+		copy_construct(lst.begin(), _size, _data);
+	}
+	
+	DynamicArray(T * iarray, const size_t sz, const Allocator& alloc = Allocator()): _alloc(alloc), _size(sz)
+	{
+		init_storage(_size);
+		copy_construct(iarray, sz, _data);
+	}
+
+	DynamicArray& operator=(const DynamicArray& idynarr)
 	{
-		size_t count = 0;
-		for(auto & element: lst)
+		if(this == &idynarr)
+			return *this;
+
+		clear();
+		if constexpr(alloc_traits::propagate_on_container_copy_assignment::value)
 		{
-			_data[count] = element;
-			++count;
+			if(_alloc != idynarr._alloc)
+			{
+				deallocate(_data, _capacity);
+				reset_storage();
+			}
+			_alloc = idynarr._alloc;
 		}
+
+		_growth_factor = idynarr._growth_factor;
+		append(idynarr._data, idynarr._size);
+		return *this;
 	}
-	
-	DynamicArray(T * iarray, const size_t sz): DynamicArray(sz)
+
+	// Steals the buffer when the allocators allow it, otherwise moves the elements one by one
+	// into memory from this array's allocator.
+	DynamicArray& operator=(DynamicArray&& idynarr) noexcept(nothrow_inline_move
+		&& (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value))
 	{
-		for(int I = 0; I < sz; ++I)
-			_data[I] = iarray[I];
+		if(this == &idynarr)
+			return *this;
+
+		clear();
+		if(!idynarr.is_inline() && (alloc_traits::propagate_on_container_move_assignment::value || _alloc == idynarr._alloc))
+		{
+			deallocate(_data, _capacity);
+			if constexpr(alloc_traits::propagate_on_container_move_assignment::value)
+				_alloc = std::move(idynarr._alloc);
+
+			_size = idynarr._size;
+			_capacity = idynarr._capacity;
+			_data = idynarr._data;
+			idynarr._size = 0;
+			idynarr.reset_storage();
+		}
+		else
+		{
+			ensure_capacity(idynarr._size);
+			for(size_t I = 0; I < idynarr._size; ++I)
+				construct(_data + I, std::move(idynarr._data[I]));
+			_size = idynarr._size;
+			idynarr.clear();
+		}
+
+		_growth_factor = idynarr._growth_factor;
+		return *this;
 	}
 
-	size_t size()
+	Allocator get_allocator() const
+	{
+		return _alloc;
+	}
+
+	size_t size() const
 	{
 		return _size;
 	}
 
+	T* data()
+	{
+		return _data;
+	}
+
+	const T* data() const
+	{
+		return _data;
+	}
+
+	// Non-owning views of the elements; they are invalidated by any reallocation.
+	std::span<T> view()
+	{
+		return std::span<T>(_data, _size);
+	}
+
+	std::span<const T> view() const
+	{
+		return std::span<const T>(_data, _size);
+	}
+
+	size_t capacity() const
+	{
+		return _capacity;
+	}
+
+	bool empty() const
+	{
+		return _size == 0;
+	}
+
+	// Capacity is multiplied by this factor whenever an append overflows it, so a sequence of appends costs amortized O(1) per element.
+	void set_growth_factor(const double factor)
+	{
+		assert(factor > 1.0);
+		_growth_factor = factor;
+	}
+
+	void reserve(const size_t new_capacity)
+	{
+		if(_capacity < new_capacity)
+			reallocate(new_capacity);
+	}
+
+	// Moves the elements back into the inline buffer when they fit there.
+	void shrink_to_fit()
+	{
+		if(_capacity > _size && !is_inline())
+			reallocate(_size);
+	}
+
 	const T& operator[](const size_t index) const 
 	{
 		assert(index < _size);
@@ -224,67 +410,349 @@ class DynamicArray
 		return _data[index];
 	}
 
-	void append(std::initializer_list<T> lst)
+	T& back()
 	{
-		const size_t new_size = _size + lst.size();
-		ensure_capacity(new_size);
-		assert(_capacity >= new_size);
-	
-		size_t count = _size;
-		for(auto& element : lst)
+		assert(_size > 0);
+		return _data[_size-1];
+	}
+
+	// Constructs the new element in place. On reallocation the element is constructed before the
+	// old elements are relocated, so args may refer to an element of this array.
+	template<class... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if(_size == _capacity)
+		{
+			const size_t new_capacity = grown_capacity(_size + 1);
+			T* new_data = allocate(new_capacity);
+			try
+			{
+				construct(new_data + _size, std::forward<Args>(args)...);
+			}
+			catch(...)
+			{
+				deallocate(new_data, new_capacity);
+				throw;
+			}
+			replace_storage(new_data, new_capacity, 1);
+		}
+		else
+		{
+			construct(_data + _size, std::forward<Args>(args)...);
+		}
+
+		return _data[_size++];
+	}
+
+	void push_back(const T& t)
+	{
+		emplace_back(t);
+	}
+
+	void push_back(T&& t)
+	{
+		emplace_back(std::move(t));
+	}
+
+	void pop_back()
+	{
+		assert(_size > 0);
+		--_size;
+		destroy(_data + _size, _data + _size + 1);
+	}
+
+	void resize(const size_t new_size)
+	{
+		if(new_size < _size)
+		{
+			destroy(_data + new_size, _data + _size);
+		}
+		else
 		{
-			_data[count] = element;
-			++count;
+			ensure_capacity(new_size);
+			for(size_t I = _size; I < new_size; ++I)
+				construct(_data + I);
 		}
 
 		_size = new_size;
 	}
 
-	void append(DynamicArray<T> idynarr)
+	void resize(const size_t new_size, const T& t)
 	{
-		const size_t new_size = _size + idynarr.size();
-		ensure_capacity(new_size);
-		assert(_capacity >= new_size);
-	
-		size_t count = _size;
-		for(int I=0;I<idynarr.size();++I)
+		if(new_size < _size)
 		{
-			_data[count] = idynarr[I];
-			++count;
+			destroy(_data + new_size, _data + _size);
+		}
+		else
+		{
+			ensure_capacity(new_size);
+			for(size_t I = _size; I < new_size; ++I)
+				construct(_data + I, t);
 		}
 
 		_size = new_size;
 	}
 
-	void append(const T* idata, const size_t sz)
+	// Destroys all the elements but keeps the capacity.
+	void clear()
+	{
+		destroy(_data, _data + _size);
+		_size = 0;
+	}
+
+	void append(std::initializer_list<T> lst)
+	{
+		append_range(lst.begin(), lst.size());
+	}
+
+	void append(const DynamicArray& idynarr)
+	{
+		append_range(idynarr._data, idynarr._size);
+	}
+
+	// Takes over the buffer of idynarr when this array is empty, otherwise moves its elements.
+	void append(DynamicArray&& idynarr)
 	{
-		const size_t new_size = _size + sz; 
+		if(this == &idynarr)
+		{
+			append_range(_data, _size);
+			return;
+		}
+
+		if(_size == 0 && !idynarr.is_inline() && _alloc == idynarr._alloc)
+		{
+			const double growth_factor = _growth_factor;
+			*this = std::move(idynarr);
+			_growth_factor = growth_factor;
+			return;
+		}
+
+		const size_t new_size = _size + idynarr._size;
 		ensure_capacity(new_size);
 		assert(_capacity >= new_size);
-	
-		size_t count = _size;
-		for(int I=0;I<sz;++I)
+
+		relocate(idynarr._data, idynarr._size, _data + _size);
+		idynarr._size = 0;
+		_size = new_size;
+	}
+
+	void append(std::span<const T> ispan)
+	{
+		append_range(ispan.data(), ispan.size());
+	}
+
+	template<std::contiguous_iterator It>
+	requires std::same_as<std::iter_value_t<It>, T>
+	void append(It first, It last)
+	{
+		assert(first <= last);
+		append_range(std::to_address(first), static_cast<size_t>(last - first));
+	}
+
+	void append(const T* idata, const size_t sz)
+	{
+		append_range(idata, sz);
+	}
+
+	private:
+	T* allocate(const size_t n)
+	{
+		if(n == 0)
+			return nullptr;
+
+		return alloc_traits::allocate(_alloc, n);
+	}
+
+	void deallocate(T* p, const size_t n)
+	{
+		if(p != nullptr && p != _inline.data())
+			alloc_traits::deallocate(_alloc, p, n);
+	}
+
+	bool is_inline()
+	{
+		return InlineCapacity > 0 && _data == _inline.data();
+	}
+
+	// Points the array at the inline buffer, or at nothing when there is none.
+	void reset_storage()
+	{
+		_data = _inline.data();
+		_capacity = InlineCapacity;
+	}
+
+	void init_storage(const size_t n)
+	{
+		if(n <= InlineCapacity)
+		{
+			reset_storage();
+		}
+		else
+		{
+			_data = allocate(n);
+			_capacity = n;
+		}
+	}
+
+	template<class... Args>
+	void construct(T* p, Args&&... args)
+	{
+		alloc_traits::construct(_alloc, p, std::forward<Args>(args)...);
+	}
+
+	void destroy(T* first, T* last)
+	{
+		for(; first != last; ++first)
+			alloc_traits::destroy(_alloc, first);
+	}
+
+	void copy_construct(const T* src, const size_t sz, T* dst)
+	{
+		if constexpr(std::is_trivially_copyable_v<T>)
+		{
+			if(sz > 0)
+				std::memcpy(dst, src, sz * sizeof(T));
+		}
+		else
+		{
+			size_t I = 0;
+			try
+			{
+				for(; I < sz; ++I)
+					construct(dst + I, src[I]);
+			}
+			catch(...)
+			{
+				destroy(dst, dst + I);
+				throw;
+			}
+		}
+	}
+
+	// Copies sz elements to the end. When the array has to grow, the source is copied into the new
+	// block before the old elements are relocated, so it may be a part of this array.
+	void append_range(const T* src, const size_t sz)
+	{
+		const size_t new_size = _size + sz;
+		if(new_size <= _capacity)
+		{
+			copy_construct(src, sz, _data + _size);
+		}
+		else
 		{
-			_data[count] = idata[I];
-			++count;
+			const size_t new_capacity = grown_capacity(new_size);
+			T* new_data = allocate(new_capacity);
+			try
+			{
+				copy_construct(src, sz, new_data + _size);
+			}
+			catch(...)
+			{
+				deallocate(new_data, new_capacity);
+				throw;
+			}
+			replace_storage(new_data, new_capacity, sz);
 		}
 
 		_size = new_size;
 	}
 
-	private:
-	void ensure_capacity(const size_t new_capacity)
+	// Relocates the live elements into new_data and releases the old block. new_data already holds
+	// extra elements after the live ones; if relocating throws they are destroyed with new_data and
+	// the array is unchanged.
+	void replace_storage(T* new_data, const size_t new_capacity, const size_t extra)
 	{
-		if(_capacity < new_capacity)
+		try
+		{
+			relocate(_data, _size, new_data);
+		}
+		catch(...)
 		{
-			T* new_data = new T[new_capacity];
+			destroy(new_data + _size, new_data + _size + extra);
+			deallocate(new_data, new_capacity);
+			throw;
+		}
+		deallocate(_data, _capacity);
+		_data = new_data;
+		_capacity = new_capacity;
+	}
+
+	size_t grown_capacity(const size_t min_capacity) const
+	{
+		size_t new_capacity = static_cast<size_t>(_capacity * _growth_factor);
+		if(new_capacity < min_capacity)
+			new_capacity = min_capacity;
+
+		return new_capacity;
+	}
+
+	void ensure_capacity(const size_t min_capacity)
+	{
+		if(_capacity < min_capacity)
+			reallocate(grown_capacity(min_capacity));
+	}
 
-			for(int I = 0; I < _size; ++I)
-				new_data[I] = _data[I];
+	void reallocate(const size_t new_capacity)
+	{
+		assert(new_capacity >= _size);
 
-			delete[] _data;
-			_data = new_data;
+		T* old_data = _data;
+		const size_t old_capacity = _capacity;
+		if(new_capacity <= InlineCapacity)
+		{
+			reset_storage();
+		}
+		else
+		{
+			_data = allocate(new_capacity);
 			_capacity = new_capacity;
 		}
+
+		try
+		{
+			relocate(old_data, _size, _data);
+		}
+		catch(...)
+		{
+			deallocate(_data, _capacity);
+			_data = old_data;
+			_capacity = old_capacity;
+			throw;
+		}
+		deallocate(old_data, old_capacity);
+	}
+
+	// Moves the elements into uninitialized memory at dst and destroys the sources.
+	// Trivially copyable types are moved with a single memcpy. Like std::vector, a T whose move
+	// constructor may throw is copied instead when it can be; if that throws, the copies made so
+	// far are destroyed and the sources are left untouched.
+	void relocate(T* src, const size_t sz, T* dst)
+	{
+		if constexpr(std::is_trivially_copyable_v<T>)
+		{
+			if(sz > 0)
+				std::memcpy(dst, src, sz * sizeof(T));
+		}
+		else
+		{
+			size_t I = 0;
+			try
+			{
+				for(; I < sz; ++I)
+					construct(dst + I, std::move_if_noexcept(src[I]));
+			}
+			catch(...)
+			{
+				destroy(dst, dst + I);
+				throw;
+			}
+			destroy(src, src + sz);
+		}
 	}
 };
+
+// Keeps up to N elements inside the object and spills to the heap only when that is exceeded.
+template<class T, size_t N, class Allocator = std::allocator<T>>
+using SmallDynamicArray = DynamicArray<T, Allocator, N>;
+
+#endif
@@ -0,0 +1,389 @@
+/* File backed dynamic array for trivially copyable types.
+*
+* The elements live in a memory mapped file laid out as a fixed Header followed by the elements, so
+* reopening an existing file is O(1): nothing is parsed or copied, pages are read lazily by the OS
+* and are shared between processes mapping the same file.
+*
+*	MappedDynamicArray<int> arr("values.bin");	// creates the file or opens it read-write
+*	arr.append({1, 2, 3});
+*
+*	const MappedDynamicArray<int> ro("values.bin", MapMode::ReadOnly);
+*
+* A ReadOnly array is read through its const members; the members that give write access or
+* change the array throw std::logic_error on it.
+*
+* The file grows geometrically with ftruncate and the mapping follows with mremap (munmap/mmap on
+* systems without mremap). Growing invalidates pointers, spans and iterators into the array.
+* The file format is native endian and is not meant to be moved between architectures.
+*/
+#ifndef MappedDynamicArray_H
+#define MappedDynamicArray_H
+
+#include <assert.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <system_error>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DynamicArray.h"
+
+enum class MapMode
+{
+	ReadOnly,
+	ReadWrite
+};
+
+template<class T>
+class MappedDynamicArray
+{
+	static_assert(std::is_trivially_copyable_v<T>, "MappedDynamicArray stores the raw bytes of its elements");
+	static_assert(alignof(T) <= 64, "elements start 64 bytes into the mapping");
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t element_size;
+		uint64_t size;
+		char reserved[40];
+	};
+
+	static_assert(sizeof(Header) == 64);
+
+	static constexpr char file_magic[8] = {'D', 'Y', 'N', 'A', 'R', 'R', 'A', 'Y'};
+	static constexpr uint32_t file_version = 1;
+	static constexpr size_t initial_capacity = 1024;
+
+	int _fd = -1;
+	MapMode _mode;
+	char* _map = nullptr;
+	size_t _map_bytes = 0;
+	size_t _capacity = 0;
+	double _growth_factor = 2.0;
+
+	public:
+
+	using Iterator = typename DynamicArray<T>::Iterator;
+	using ConstIterator = typename DynamicArray<T>::ConstIterator;
+
+	MappedDynamicArray(const std::string& path, const MapMode mode = MapMode::ReadWrite): _mode(mode)
+	{
+		const bool writable = _mode == MapMode::ReadWrite;
+		_fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+		if(_fd < 0)
+			throw std::system_error(errno, std::generic_category(), "open " + path);
+
+		struct stat st;
+		if(::fstat(_fd, &st) != 0)
+			fail("fstat " + path);
+
+		size_t file_bytes = static_cast<size_t>(st.st_size);
+		const bool created = file_bytes == 0 && writable;
+		if(created)
+		{
+			file_bytes = bytes_for(initial_capacity);
+			if(::ftruncate(_fd, file_bytes) != 0)
+				fail("ftruncate " + path);
+		}
+
+		if(file_bytes < sizeof(Header))
+		{
+			::close(_fd);
+			throw std::runtime_error(path + " is not a MappedDynamicArray file");
+		}
+
+		map(file_bytes);
+
+		if(created)
+		{
+			Header* h = header();
+			std::memcpy(h->magic, file_magic, sizeof(file_magic));
+			h->version = file_version;
+			h->element_size = sizeof(T);
+			h->size = 0;
+		}
+
+		const Header* h = header();
+		if(std::memcmp(h->magic, file_magic, sizeof(file_magic)) != 0 || h->version != file_version
+			|| h->element_size != sizeof(T) || h->size > _capacity)
+		{
+			unmap();
+			::close(_fd);
+			throw std::runtime_error(path + " is not a MappedDynamicArray file of this element type");
+		}
+	}
+
+	MappedDynamicArray(const MappedDynamicArray&) = delete;
+	MappedDynamicArray& operator=(const MappedDynamicArray&) = delete;
+
+	// The moved from array is empty and has no file.
+	MappedDynamicArray(MappedDynamicArray&& iarr) noexcept: _fd(iarr._fd), _mode(iarr._mode), _map(iarr._map),
+		_map_bytes(iarr._map_bytes), _capacity(iarr._capacity), _growth_factor(iarr._growth_factor)
+	{
+		iarr._fd = -1;
+		iarr._map = nullptr;
+		iarr._map_bytes = 0;
+		iarr._capacity = 0;
+	}
+
+	MappedDynamicArray& operator=(MappedDynamicArray&& iarr) noexcept
+	{
+		if(this == &iarr)
+			return *this;
+
+		unmap();
+		if(_fd >= 0)
+			::close(_fd);
+
+		_fd = std::exchange(iarr._fd, -1);
+		_mode = iarr._mode;
+		_map = std::exchange(iarr._map, nullptr);
+		_map_bytes = std::exchange(iarr._map_bytes, 0);
+		_capacity = std::exchange(iarr._capacity, 0);
+		_growth_factor = iarr._growth_factor;
+		return *this;
+	}
+
+	~MappedDynamicArray()
+	{
+		unmap();
+		if(_fd >= 0)
+			::close(_fd);
+	}
+
+	Iterator begin()
+	{
+		return Iterator(data());
+	}
+
+	Iterator end()
+	{
+		return Iterator(data() + size());
+	}
+
+	ConstIterator begin() const
+	{
+		return ConstIterator(data());
+	}
+
+	ConstIterator end() const
+	{
+		return ConstIterator(data() + size());
+	}
+
+	size_t size() const
+	{
+		return _map != nullptr ? header()->size : 0;
+	}
+
+	size_t capacity() const
+	{
+		return _capacity;
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// Throws std::logic_error on a ReadOnly array, as do all the non-const members below.
+	T* data()
+	{
+		check_writable();
+		return elements();
+	}
+
+	const T* data() const
+	{
+		return elements();
+	}
+
+	std::span<T> view()
+	{
+		return std::span<T>(data(), size());
+	}
+
+	std::span<const T> view() const
+	{
+		return std::span<const T>(data(), size());
+	}
+
+	const T& operator[](const size_t index) const
+	{
+		assert(index < size());
+		return data()[index];
+	}
+
+	T& operator[](const size_t index)
+	{
+		assert(index < size());
+		return data()[index];
+	}
+
+	void set_growth_factor(const double factor)
+	{
+		assert(factor > 1.0);
+		_growth_factor = factor;
+	}
+
+	void reserve(const size_t new_capacity)
+	{
+		check_writable();
+		if(_capacity < new_capacity)
+			resize_file(new_capacity);
+	}
+
+	// Truncates the file to the elements in use.
+	void shrink_to_fit()
+	{
+		check_writable();
+		if(_capacity > size())
+			resize_file(size());
+	}
+
+	void push_back(const T& t)
+	{
+		append(&t, 1);
+	}
+
+	void append(std::initializer_list<T> lst)
+	{
+		append(lst.begin(), lst.size());
+	}
+
+	void append(std::span<const T> ispan)
+	{
+		append(ispan.data(), ispan.size());
+	}
+
+	void append(const T* idata, const size_t sz)
+	{
+		check_writable();
+
+		const size_t old_size = size();
+		const size_t new_size = old_size + sz;
+		if(new_size > _capacity)
+		{
+			// The source may be inside the mapping, which can move when the file grows.
+			const T* base = elements();
+			const bool aliased = idata >= base && idata < base + _capacity;
+			const size_t offset = aliased ? idata - base : 0;
+
+			size_t new_capacity = static_cast<size_t>(_capacity * _growth_factor);
+			if(new_capacity < new_size)
+				new_capacity = new_size;
+			resize_file(new_capacity);
+
+			if(aliased)
+				idata = elements() + offset;
+		}
+
+		if(sz > 0)
+			std::memmove(elements() + old_size, idata, sz * sizeof(T));
+		header()->size = new_size;
+	}
+
+	void pop_back()
+	{
+		check_writable();
+		assert(size() > 0);
+		--header()->size;
+	}
+
+	void clear()
+	{
+		check_writable();
+		header()->size = 0;
+	}
+
+	// Flushes the dirty pages to the file; without it they are written back by the OS eventually.
+	void sync()
+	{
+		if(_map != nullptr && ::msync(_map, _map_bytes, MS_SYNC) != 0)
+			throw std::system_error(errno, std::generic_category(), "msync");
+	}
+
+	private:
+
+	static size_t bytes_for(const size_t capacity)
+	{
+		return sizeof(Header) + capacity * sizeof(T);
+	}
+
+	Header* header() const
+	{
+		return reinterpret_cast<Header*>(_map);
+	}
+
+	T* elements() const
+	{
+		return _map != nullptr ? reinterpret_cast<T*>(_map + sizeof(Header)) : nullptr;
+	}
+
+	void check_writable() const
+	{
+		if(_mode != MapMode::ReadWrite)
+			throw std::logic_error("MappedDynamicArray is mapped ReadOnly");
+	}
+
+	[[noreturn]] void fail(const std::string& msg)
+	{
+		const int err = errno;
+		unmap();
+		::close(_fd);
+		_fd = -1;
+		throw std::system_error(err, std::generic_category(), msg);
+	}
+
+	void map(const size_t file_bytes)
+	{
+		const int prot = _mode == MapMode::ReadWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+		void* p = ::mmap(nullptr, file_bytes, prot, MAP_SHARED, _fd, 0);
+		if(p == MAP_FAILED)
+			fail("mmap");
+
+		_map = static_cast<char*>(p);
+		_map_bytes = file_bytes;
+		_capacity = (file_bytes - sizeof(Header)) / sizeof(T);
+	}
+
+	void unmap()
+	{
+		if(_map != nullptr)
+			::munmap(_map, _map_bytes);
+		_map = nullptr;
+		_map_bytes = 0;
+	}
+
+	void resize_file(const size_t new_capacity)
+	{
+
+		const size_t new_bytes = bytes_for(new_capacity);
+		if(::ftruncate(_fd, new_bytes) != 0)
+			throw std::system_error(errno, std::generic_category(), "ftruncate");
+
+#ifdef MREMAP_MAYMOVE
+		void* p = ::mremap(_map, _map_bytes, new_bytes, MREMAP_MAYMOVE);
+		if(p == MAP_FAILED)
+			throw std::system_error(errno, std::generic_category(), "mremap");
+
+		_map = static_cast<char*>(p);
+		_map_bytes = new_bytes;
+		_capacity = new_capacity;
+#else
+		unmap();
+		map(new_bytes);
+#endif
+	}
+};
+
+#endif
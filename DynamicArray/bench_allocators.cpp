@@ -0,0 +1,103 @@
+/* Benchmark of request-scoped DynamicArray workloads with different allocators.
+*
+* Every simulated request builds a few dozen short-lived arrays of small records and drops them.
+* The same workload is run against the global heap (std::allocator), MonotonicArena,
+* SizeClassPool and std::pmr::monotonic_buffer_resource.
+*/
+#include <assert.h>
+#include <iostream>
+#include <chrono>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "DynamicArray.h"
+#include "Allocators.h"
+
+using namespace std;
+
+struct Record
+{
+	long long id;
+	double value;
+};
+
+const int num_requests = 200000;
+const int arrays_per_request = 32;
+
+// Sizes of the arrays built by a request; drawn once so all allocators see the same workload.
+vector<int> make_sizes()
+{
+	srand(42);
+	vector<int> sizes(arrays_per_request);
+	for(auto& sz: sizes)
+		sz = 1 + rand() % 64;
+	return sizes;
+}
+
+template<class Alloc>
+long long run_request(const vector<int>& sizes, const Alloc& alloc)
+{
+	using RecordAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Record>;
+
+	long long checksum = 0;
+	for(const int sz: sizes)
+	{
+		DynamicArray<Record, RecordAlloc> records{RecordAlloc(alloc)};
+		for(int I = 0; I < sz; ++I)
+			records.push_back({I, I * 0.5});
+		checksum += records.size() + records[sz-1].id;
+	}
+
+	return checksum;
+}
+
+template<class Fn>
+void time_requests(const string& msg, Fn fn)
+{
+	auto start = chrono::steady_clock::now();
+
+	long long checksum = 0;
+	for(int I = 0; I < num_requests; ++I)
+		checksum += fn();
+
+	auto end = chrono::steady_clock::now();
+	auto tm = chrono::duration_cast<chrono::milliseconds>(end-start).count();
+
+	cout << "\n" << msg << tm << " milli-seconds (checksum " << checksum << ")";
+}
+
+int main()
+{
+	const vector<int> sizes = make_sizes();
+
+	time_requests("Global heap (std::allocator) = ", [&]() {
+		return run_request(sizes, std::allocator<Record>());
+	});
+
+	MonotonicArena arena;
+	time_requests("MonotonicArena = ", [&]() {
+		const long long checksum = run_request(sizes, ArenaAllocator<Record>(arena));
+		arena.release();
+		return checksum;
+	});
+
+	SizeClassPool pool;
+	time_requests("SizeClassPool = ", [&]() {
+		return run_request(sizes, PoolAllocator<Record>(pool));
+	});
+
+	std::pmr::unsynchronized_pool_resource upstream;
+	time_requests("std::pmr::monotonic_buffer_resource = ", [&]() {
+		std::pmr::monotonic_buffer_resource resource(64 * 1024, &upstream);
+		return run_request(sizes, std::pmr::polymorphic_allocator<Record>(&resource));
+	});
+
+	// Allocator-aware construction reaches the elements as well.
+	std::pmr::monotonic_buffer_resource resource;
+	DynamicArray<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>> names{&resource};
+	names.push_back("a string long enough to need its own allocation");
+	assert(names[0].get_allocator().resource() == &resource);
+
+	cout << endl;
+	return 0;
+}
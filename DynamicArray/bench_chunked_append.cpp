@@ -0,0 +1,59 @@
+/* Append latency of ChunkedDynamicArray against the contiguous DynamicArray.
+*
+* Appends are timed in batches of 1024 (a clock read per element would dominate the measurement);
+* the percentiles show how the occasional full reallocation of DynamicArray turns into latency
+* spikes once the array is a few hundred MB, while the chunked array stays flat.
+*/
+#include <assert.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "DynamicArray.h"
+#include "ChunkedDynamicArray.h"
+
+using namespace std;
+
+const size_t total_appends = size_t(1) << 27;	// 512 MB of ints
+const size_t batch = 1024;
+
+template<class Array>
+void latency_test(const string& msg)
+{
+	vector<double> batch_ns;
+	batch_ns.reserve(total_appends / batch);
+
+	Array arr;
+	auto start = chrono::steady_clock::now();
+	for(size_t I = 0; I < total_appends; I += batch)
+	{
+		auto batch_start = chrono::steady_clock::now();
+		for(size_t J = 0; J < batch; ++J)
+			arr.push_back(static_cast<int>(I + J));
+		auto batch_end = chrono::steady_clock::now();
+		batch_ns.push_back(chrono::duration<double, nano>(batch_end - batch_start).count());
+	}
+	auto end = chrono::steady_clock::now();
+	assert(arr.size() == total_appends);
+	assert(arr[total_appends - 1] == static_cast<int>(total_appends - 1));
+
+	sort(batch_ns.begin(), batch_ns.end());
+	auto percentile = [&](const double p) {
+		return batch_ns[static_cast<size_t>(p * (batch_ns.size() - 1))] / 1000.0;
+	};
+
+	cout << "\n" << msg << chrono::duration_cast<chrono::milliseconds>(end - start).count() << " milli-seconds total"
+		<< ", per " << batch << " appends: p50 = " << percentile(0.5) << " us"
+		<< ", p99 = " << percentile(0.99) << " us"
+		<< ", p99.99 = " << percentile(0.9999) << " us"
+		<< ", max = " << batch_ns.back() / 1000.0 << " us";
+}
+
+int main()
+{
+	latency_test<DynamicArray<int>>("DynamicArray<int>: ");
+	latency_test<ChunkedDynamicArray<int>>("ChunkedDynamicArray<int>: ");
+	cout << endl;
+	return 0;
+}
@@ -0,0 +1,105 @@
+/* Multi-producer append throughput: ConcurrentDynamicArray against a DynamicArray guarded by a mutex,
+* from 1 thread up to the number of hardware threads. A reader thread iterates the published prefix
+* while the producers run. The maximum thread count can be given as the first argument.
+*/
+#include <assert.h>
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DynamicArray.h"
+#include "ConcurrentDynamicArray.h"
+
+using namespace std;
+
+const size_t total_appends = 8000000;
+
+template<class AppendFn>
+double run_producers(const unsigned num_threads, AppendFn append)
+{
+	const size_t per_thread = total_appends / num_threads;
+
+	auto start = chrono::steady_clock::now();
+	vector<thread> producers;
+	for(unsigned t = 0; t < num_threads; ++t)
+	{
+		producers.emplace_back([=]() {
+			for(size_t I = 0; I < per_thread; ++I)
+				append(static_cast<long long>(t * per_thread + I));
+		});
+	}
+	for(auto& producer: producers)
+		producer.join();
+	auto end = chrono::steady_clock::now();
+
+	const double ms = chrono::duration<double, milli>(end-start).count();
+	return per_thread * num_threads / (ms * 1000.0);
+}
+
+int main(int argc, char* argv[])
+{
+	const int max_threads = argc > 1 ? atoi(argv[1]) : max(1u, thread::hardware_concurrency());
+	if(max_threads < 1)
+	{
+		cerr << "usage: " << argv[0] << " [max_threads >= 1]" << endl;
+		return 1;
+	}
+
+	// Powers of two below max_threads, then max_threads itself.
+	vector<unsigned> thread_counts;
+	for(int num_threads = 1; num_threads < max_threads; num_threads *= 2)
+		thread_counts.push_back(num_threads);
+	thread_counts.push_back(max_threads);
+
+	for(const unsigned num_threads: thread_counts)
+	{
+		DynamicArray<long long> locked;
+		mutex mtx;
+		const double locked_mops = run_producers(num_threads, [&](const long long v) {
+			lock_guard<mutex> guard(mtx);
+			locked.push_back(v);
+		});
+
+		ConcurrentDynamicArray<long long> concurrent;
+		atomic<bool> done{false};
+		size_t reader_passes = 0;
+		thread reader([&]() {
+			while(!done.load())
+			{
+				long long sum = 0;
+				for(const long long v: concurrent)
+					sum += v;
+				assert(sum >= 0);
+				++reader_passes;
+			}
+		});
+
+		const double concurrent_mops = run_producers(num_threads, [&](const long long v) {
+			concurrent.push_back(v);
+		});
+		done = true;
+		reader.join();
+
+		const size_t expected = total_appends / num_threads * num_threads;
+		assert(locked.size() == expected);
+		assert(concurrent.published_size() == expected);
+
+		long long sum = 0;
+		for(const long long v: concurrent)
+			sum += v;
+		assert(sum == static_cast<long long>(expected * (expected - 1) / 2));
+
+		cout << "\nthreads = " << num_threads
+			<< "  mutex + DynamicArray = " << locked_mops << " M appends/sec"
+			<< "  ConcurrentDynamicArray = " << concurrent_mops << " M appends/sec"
+			<< "  (reader passes " << reader_passes << ")";
+	}
+
+	cout << endl;
+	return 0;
+}
@@ -11,11 +11,396 @@
 #include <assert.h>
 #include <iostream>
 #include "DynamicArray.h"
+#include "MappedDynamicArray.h"
+#include "ChunkedDynamicArray.h"
 #include <string>
 #include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
 
 using namespace std;
 
+// Has no default constructor and counts the live instances.
+struct Tracked
+{
+	static int live;
+	int value;
+
+	Tracked(const int ivalue): value(ivalue) { ++live; }
+	Tracked(const Tracked& t): value(t.value) { ++live; }
+	~Tracked() { --live; }
+};
+
+int Tracked::live = 0;
+
+// Move constructor that may throw, and a copy constructor that throws once copies_left runs out.
+struct Fragile
+{
+	static int copies_left;
+	int value;
+
+	Fragile(const int ivalue): value(ivalue) {}
+	Fragile(const Fragile& f): value(f.value)
+	{
+		if(copies_left-- == 0)
+			throw std::runtime_error("copy failed");
+	}
+	Fragile(Fragile&& f): value(f.value) { f.value = -1; }
+};
+
+int Fragile::copies_left = 1000;
+
+void storage_test()
+{
+	{
+		DynamicArray<Tracked> arr;
+		arr.reserve(1000);
+		assert(Tracked::live == 0);
+
+		arr.emplace_back(1);
+		arr.push_back(Tracked(2));
+		arr.emplace_back(arr[0]);
+		assert(arr.size() == 3);
+		assert(arr[2].value == 1);
+		assert(Tracked::live == 3);
+
+		arr.pop_back();
+		assert(Tracked::live == 2);
+
+		arr.resize(5, Tracked(7));
+		assert(arr[4].value == 7);
+		assert(Tracked::live == 5);
+
+		arr.resize(1, Tracked(0));
+		assert(Tracked::live == 1);
+
+		arr.clear();
+		assert(arr.size() == 0);
+		assert(Tracked::live == 0);
+		assert(arr.capacity() == 1000);
+
+		for(int I = 0; I < 100; ++I)
+			arr.emplace_back(I);
+	}
+	assert(Tracked::live == 0);
+
+	DynamicArray<string> names{"a", "b"};
+	DynamicArray<string> copy;
+	copy = names;
+	names.push_back("c");
+	assert(copy.size() == 2);
+	copy = std::move(names);
+	assert(copy.size() == 3);
+	assert(copy.back() == "c");
+
+	DynamicArray<int> zeros;
+	zeros.resize(10);
+	assert(zeros[9] == 0);
+
+	// Containers of arrays move them when they grow.
+	static_assert(std::is_nothrow_move_constructible_v<DynamicArray<string>>);
+	static_assert(std::is_nothrow_move_assignable_v<DynamicArray<string>>);
+	static_assert(std::is_nothrow_move_constructible_v<SmallDynamicArray<string, 4>>);
+	vector<DynamicArray<string>> arrays;
+	arrays.emplace_back(DynamicArray<string>{"Ramesh"});
+	const string* buffer = arrays[0].data();
+	for(int I = 0; I < 100; ++I)
+		arrays.emplace_back();
+	assert(arrays[0].data() == buffer);
+
+	// Growth copies a T whose move may throw, so a failed copy leaves the array as it was.
+	DynamicArray<Fragile> fragile;
+	fragile.reserve(4);
+	for(int I = 0; I < 4; ++I)
+		fragile.emplace_back(I);
+	Fragile::copies_left = 2;
+	bool thrown = false;
+	try
+	{
+		fragile.emplace_back(4);
+	}
+	catch(const std::runtime_error&)
+	{
+		thrown = true;
+	}
+	Fragile::copies_left = 1000;
+	assert(thrown);
+	assert(fragile.size() == 4 && fragile.capacity() == 4);
+	for(int I = 0; I < 4; ++I)
+		assert(fragile[I].value == I);
+}
+
+void small_array_test()
+{
+	SmallDynamicArray<string, 4> names{"Ramesh", "Kavitha"};
+	assert(names.capacity() == 4);
+	names.append({"Mahesh"});
+	assert(names.capacity() == 4);
+
+	SmallDynamicArray<string, 4> moved(std::move(names));
+	assert(moved.size() == 3);
+	assert(names.size() == 0);
+	assert(moved[2] == "Mahesh");
+
+	moved.append({"Tom", "Robert"});
+	assert(moved.size() == 5);
+	assert(moved.capacity() > 4);
+	std::sort(moved.begin(), moved.end());
+	assert(moved[0] == "Kavitha");
+
+	SmallDynamicArray<string, 4> copy(moved);
+	copy.pop_back();
+	copy.pop_back();
+	copy.shrink_to_fit();
+	assert(copy.capacity() == 4);
+	assert(copy[2] == "Ramesh");
+
+	names = std::move(moved);
+	assert(names.size() == 5);
+	names = copy;
+	assert(names.size() == 3);
+	assert(names.capacity() >= 3);
+
+	static_assert(sizeof(DynamicArray<int>) < sizeof(SmallDynamicArray<int, 16>));
+}
+
+void append_range_test()
+{
+	static_assert(std::contiguous_iterator<DynamicArray<int>::Iterator>);
+	static_assert(std::contiguous_iterator<DynamicArray<int>::ConstIterator>);
+
+	DynamicArray<int> nums{1, 2, 3};
+	nums.append(nums.view());
+	assert(nums.size() == 6);
+	assert(nums[5] == 3);
+
+	vector<int> vec{7, 8, 9};
+	nums.append(vec.begin(), vec.end());
+	nums.append(std::span<const int>(vec).subspan(1));
+	assert(nums.size() == 11);
+	assert(nums[10] == 9);
+
+	DynamicArray<int> other{4, 5};
+	nums.append(other.begin(), other.end());
+	assert(nums[12] == 5);
+
+	DynamicArray<string> dst;
+	DynamicArray<string> src{"Ramesh", "Kavitha"};
+	const string* buffer = src.data();
+	dst.append(std::move(src));
+	assert(dst.data() == buffer);
+	assert(src.size() == 0);
+
+	DynamicArray<string> more{"Mahesh"};
+	dst.append(std::move(more));
+	assert(dst.size() == 3);
+	assert(dst[2] == "Mahesh");
+
+	dst.append(dst);
+	assert(dst.size() == 6);
+	assert(dst[5] == "Mahesh");
+
+	std::span<const string> names = std::as_const(dst).view();
+	assert(names.size() == 6);
+	assert(names[0] == "Ramesh");
+
+	// A const array is iterated with ConstIterator, which an Iterator converts to.
+	const DynamicArray<string>& cdst = dst;
+	static_assert(std::is_same_v<decltype(*cdst.begin()), const string&>);
+	size_t count = 0;
+	for(const string& name: cdst)
+		count += name == "Mahesh";
+	assert(count == 2);
+	DynamicArray<string>::ConstIterator first = dst.begin();
+	assert(first == cdst.begin() && cdst.end() - first == 6);
+}
+
+void mapped_array_test()
+{
+	const string path = (filesystem::temp_directory_path() / "test_dyn_array.bin").string();
+	filesystem::remove(path);
+
+	{
+		MappedDynamicArray<int> arr(path);
+		assert(arr.size() == 0);
+		for(int I = 0; I < 5000; ++I)
+			arr.push_back(I);
+		arr.append(arr.view().subspan(0, 10));
+		assert(arr.size() == 5010);
+		assert(arr[5009] == 9);
+		arr.sync();
+	}
+
+	{
+		const MappedDynamicArray<int> ro(path, MapMode::ReadOnly);
+		assert(ro.size() == 5010);
+		assert(ro[4999] == 4999);
+		assert(*std::max_element(ro.begin(), ro.end()) == 4999);
+		static_assert(std::is_same_v<decltype(ro.view()), std::span<const int>>);
+
+		// Write access to a ReadOnly array is refused instead of faulting.
+		MappedDynamicArray<int> writable_ro(path, MapMode::ReadOnly);
+		bool refused = false;
+		try
+		{
+			writable_ro[0] = 1;
+		}
+		catch(const std::logic_error&)
+		{
+			refused = true;
+		}
+		assert(refused);
+		refused = false;
+		try
+		{
+			writable_ro.append({1});
+		}
+		catch(const std::logic_error&)
+		{
+			refused = true;
+		}
+		assert(refused && writable_ro.size() == 5010);
+	}
+
+	{
+		// Moves leave an empty array behind and can replace an open one.
+		static_assert(std::is_nothrow_move_constructible_v<MappedDynamicArray<int>>);
+		static_assert(std::is_nothrow_move_assignable_v<MappedDynamicArray<int>>);
+		MappedDynamicArray<int> arr(path);
+		MappedDynamicArray<int> moved(std::move(arr));
+		assert(arr.size() == 0 && arr.empty());
+		assert(moved.size() == 5010);
+
+		MappedDynamicArray<int> other(path, MapMode::ReadOnly);
+		other = std::move(moved);
+		assert(moved.empty() && other.size() == 5010);
+		other.push_back(7);
+		assert(other.size() == 5011);
+	}
+
+	bool rejected = false;
+	try
+	{
+		MappedDynamicArray<double> wrong(path, MapMode::ReadOnly);
+	}
+	catch(const std::runtime_error&)
+	{
+		rejected = true;
+	}
+	assert(rejected);
+
+	filesystem::remove(path);
+}
+
+void chunked_array_test()
+{
+	ChunkedDynamicArray<string, 2> names{"Ramesh", "Kavitha", "Mahesh"};
+	const string* first = &names[0];
+	for(int I = 0; I < 20; ++I)
+		names.push_back(to_string(I));
+	assert(&names[0] == first);
+	assert(names.size() == 23);
+	assert(names[22] == "19");
+
+	std::sort(names.begin(), names.end());
+	assert(names[0] == "0");
+	assert(*std::find(names.begin(), names.end(), "Mahesh") == "Mahesh");
+
+	ChunkedDynamicArray<string, 2> copy(names);
+	names.pop_back();
+	names.shrink_to_fit();
+	assert(names.size() == 22);
+	assert(copy.size() == 23);
+	copy = std::move(names);
+	assert(copy.size() == 22);
+
+	// Iterators taken before appends that grow the chunk pointer table still reach the elements.
+	ChunkedDynamicArray<int, 2> numbers{7, 8};
+	auto itr = numbers.begin();
+	auto second = itr + 1;
+	for(int I = 0; I < 100; ++I)
+		numbers.push_back(I);
+	assert(*itr == 7 && *second == 8);
+	assert(itr[101] == 99);
+	assert(numbers.end() - itr == 102);
+
+	// A const array hands out const elements.
+	const ChunkedDynamicArray<int, 2>& cnumbers = numbers;
+	static_assert(std::is_same_v<decltype(*cnumbers.begin()), const int&>);
+	static_assert(std::is_same_v<decltype(*numbers.begin()), int&>);
+	ChunkedDynamicArray<int, 2>::ConstIterator citr = itr;
+	assert(citr == cnumbers.begin() && *citr == 7);
+	long long sum = 0;
+	for(const int x: cnumbers)
+		sum += x;
+	assert(sum == 7 + 8 + 99 * 100 / 2);
+}
+
+template<class Fn>
+long long time_ms(Fn fn)
+{
+	auto start = chrono::steady_clock::now();
+	fn();
+	auto end = chrono::steady_clock::now();
+	return chrono::duration_cast<chrono::milliseconds>(end-start).count();
+}
+
+void print_throughput(const string& msg, const size_t count, const long long ms)
+{
+	const double mops = ms > 0 ? count / (ms * 1000.0) : 0.0;
+	cout << "\n" << msg << ms << " milli-seconds (" << mops << " million appends/sec)";
+}
+
+// Compares a loop of single element appends against std::vector::push_back.
+void append_benchmark()
+{
+	const size_t count = 10000000;
+
+	size_t dyn_size = 0, vec_size = 0;
+	auto tm = time_ms([&]() {
+		DynamicArray<int> arr;
+		for(size_t I = 0; I < count; ++I)
+			arr.append({static_cast<int>(I)});
+		dyn_size = arr.size();
+	});
+	print_throughput("DynamicArray<int> append = ", count, tm);
+
+	tm = time_ms([&]() {
+		vector<int> vec;
+		for(size_t I = 0; I < count; ++I)
+			vec.push_back(static_cast<int>(I));
+		vec_size = vec.size();
+	});
+	print_throughput("std::vector<int> push_back = ", count, tm);
+	assert(dyn_size == vec_size);
+
+	const size_t str_count = count / 10;
+	const string record = "a record long enough to defeat small string optimization";
+
+	tm = time_ms([&]() {
+		DynamicArray<string> arr;
+		for(size_t I = 0; I < str_count; ++I)
+			arr.append({record});
+		dyn_size = arr.size();
+	});
+	print_throughput("DynamicArray<string> append = ", str_count, tm);
+
+	tm = time_ms([&]() {
+		vector<string> vec;
+		for(size_t I = 0; I < str_count; ++I)
+			vec.push_back(record);
+		vec_size = vec.size();
+	});
+	print_throughput("std::vector<string> push_back = ", str_count, tm);
+	assert(dyn_size == vec_size);
+
+	cout << endl;
+}
+
 int main()
 {
 	DynamicArray<int> idynarr{1, 2, 3, 4};
@@ -60,4 +445,28 @@ int main()
 
 	itr1--;
 	cout << "\n\n name after decrementing iterator = " << *itr1;
+
+	DynamicArray<int> grown;
+	grown.set_growth_factor(1.5);
+	grown.reserve(10);
+	assert(grown.capacity() == 10);
+	for(int I = 0; I < 100; ++I)
+		grown.append({I});
+	assert(grown.size() == 100);
+	assert(grown.capacity() >= 100);
+	assert(grown[99] == 99);
+	grown.shrink_to_fit();
+	assert(grown.capacity() == 100);
+	assert(grown[50] == 50);
+
+	storage_test();
+	small_array_test();
+	append_range_test();
+	mapped_array_test();
+	chunked_array_test();
+
+	cout << "\n";
+	append_benchmark();
+
+	return 0;
 }
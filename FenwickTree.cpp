@@ -0,0 +1,161 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <assert.h>
+#include "FenwickTree.h"
+
+using namespace std;
+
+// Random updates, range sums and lower bounds against a plain array.
+void validate(const int n)
+{
+	mt19937 gen(n);
+	vector<int> v(n);
+	for(auto& x: v)
+		x = gen() % 100;
+
+	FenwickTree ft(v);
+	for(int op = 0; op < 20000; ++op)
+	{
+		const int i = gen() % n;
+		const int delta = gen() % 50;
+		v[i] += delta;
+		ft.Add(i, delta);
+
+		int l = gen() % n, r = gen() % n;
+		if(l > r)
+			swap(l, r);
+		long long expected = 0;
+		for(int k = l; k <= r; ++k)
+			expected += v[k];
+		assert(ft.RangeSumQuery(l, r) == expected);
+
+		// Partial sums that are hit exactly, fall between two prefixes, and exceed the total.
+		long long prefix = 0;
+		const long long target = gen() % (ft.PrefixSum(n-1) + 2);
+		int lb = 0;
+		while(lb < n && prefix + v[lb] < target)
+			prefix += v[lb++];
+		assert(ft.LowerBound(target) == lb);
+	}
+}
+
+void test()
+{
+	FenwickTree ft(vector<int>{1, 2, 3, 4, 5, 6, 7, 8});
+	assert(ft.RangeSumQuery(3, 5) == 15);
+	ft.Add(4, 10);
+	assert(ft.RangeSumQuery(3, 5) == 25);
+	assert(ft.PrefixSum(7) == 46);
+	assert(ft.LowerBound(6) == 2);
+	assert(ft.LowerBound(7) == 3);
+	assert(ft.LowerBound(47) == 8);
+
+	// Counters whose total exceeds 2^31
+	FenwickTree<int> counters(1000);
+	for(int i = 0; i < 1000; ++i)
+		counters.Add(i, 3000000);
+	assert(counters.RangeSumQuery(0, 999) == 3000000000ll);
+
+	validate(1);
+	validate(7);
+	validate(1000);
+
+	cout << "\nFenwick tree tests successful" << endl;
+}
+
+// ops operations over n counters, a fraction update_ratio of them Add and the rest RangeSumQuery.
+// PrefixSumArray is rebuilt before a query only if an update came since the last rebuild.
+void benchmark(const int n, const double update_ratio)
+{
+	mt19937 gen(n);
+	vector<int> v(n);
+	for(auto& x: v)
+		x = gen() % 1000;
+
+	struct Op
+	{
+		bool update;
+		int a, b;
+	};
+
+	auto make_ops = [&](const int count) {
+		vector<Op> ops(count);
+		for(auto& op: ops)
+		{
+			op.update = gen() < update_ratio * mt19937::max();
+			op.a = gen() % n;
+			op.b = op.update ? gen() % 100 : gen() % n;
+			if(!op.update && op.a > op.b)
+				swap(op.a, op.b);
+		}
+		return ops;
+	};
+
+	const int ft_ops = 2000000;
+	const vector<Op> ops = make_ops(ft_ops);
+
+	// A rebuild is O(n), so PrefixSumArray gets a prefix of the operations sized to about a second.
+	const int psa_ops = min<long long>(ft_ops, max<long long>(1000, 1e9 / n / max(1e-3, update_ratio)));
+
+	FenwickTree ft(v);
+	long long ft_total = 0, ft_prefix_total = 0;
+	auto start = chrono::steady_clock::now();
+	for(int k = 0; k < ft_ops; ++k)
+	{
+		const Op& op = ops[k];
+		if(k == psa_ops)
+			ft_prefix_total = ft_total;
+		if(op.update)
+			ft.Add(op.a, op.b);
+		else
+			ft_total += ft.RangeSumQuery(op.a, op.b);
+	}
+	auto end = chrono::steady_clock::now();
+	const double ft_ns = chrono::duration<double, nano>(end-start).count() / ft_ops;
+	if(psa_ops == ft_ops)
+		ft_prefix_total = ft_total;
+	vector<int> w(v);
+	PrefixSumArray<int> psa(w);
+	bool dirty = false;
+	long long psa_total = 0;
+	start = chrono::steady_clock::now();
+	for(int k = 0; k < psa_ops; ++k)
+	{
+		const Op& op = ops[k];
+		if(op.update)
+		{
+			w[op.a] += op.b;
+			dirty = true;
+			continue;
+		}
+		if(dirty)
+		{
+			psa = PrefixSumArray<int>(w);
+			dirty = false;
+		}
+		psa_total += psa.RangeSumQuery(op.a, op.b);
+	}
+	end = chrono::steady_clock::now();
+	const double psa_ns = chrono::duration<double, nano>(end-start).count() / psa_ops;
+
+	assert(psa_total == ft_prefix_total);
+
+	cout << "n = " << n << ", " << update_ratio * 100 << "% updates: FenwickTree " << ft_ns << " ns/op, rebuilt PrefixSumArray "
+		<< psa_ns << " ns/op over the first " << psa_ops << " ops (checksums " << ft_prefix_total << ", " << psa_total << ")" << endl;
+}
+
+int main()
+{
+	test();
+
+	cout << endl;
+	for(int n: {10000, 1000000})
+		for(double ratio: {0.0, 0.001, 0.01, 0.1, 0.5, 0.9})
+			benchmark(n, ratio);
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+#ifndef FenwickTree_H
+#define FenwickTree_H
+
+#include <vector>
+#include <span>
+#include <bit>
+#include <assert.h>
+#include "PrefixSumArray.h"
+
+// Prefix sums that can be updated: a Fenwick tree (binary indexed tree) answers PrefixSum and
+// RangeSumQuery and applies Add(i, delta) in O(log n) each, where PrefixSumArray has O(1) queries
+// but must be rebuilt in O(n) after any change.
+//
+// v is 1-based: v[k] holds the sum of the (k & -k) input values ending at k-1. A prefix sum adds
+// the nodes found by clearing the lowest set bit of k, an update the nodes found by adding it.
+// Acc defaults to the same wide types as PrefixSumArray; floating point sums are not compensated
+// since every update would have to carry the compensation of O(log n) nodes.
+template<class T = int, class Acc = PrefixSumType<T>>
+class FenwickTree
+{
+	int n;
+	std::vector<Acc> v;
+
+	public:
+
+	FenwickTree(const int in = 0): n(in), v(in + 1) {}
+	FenwickTree(const std::vector<T>& iv): FenwickTree(std::span<const T>(iv)) {}
+	FenwickTree(std::span<const T> iv);
+
+	int size() const
+	{
+		return n;
+	}
+
+	// input[i] += delta
+	void Add(int i, const Acc delta)
+	{
+		assert(0 <= i && i < n);
+		for(++i; i <= n; i += i & -i)
+			v[i] += delta;
+	}
+
+	// Sum of the input values [0, i]
+	Acc PrefixSum(int i) const
+	{
+		assert(0 <= i && i < n);
+		Acc sum = 0;
+		for(++i; i > 0; i &= i - 1)
+			sum += v[i];
+		return sum;
+	}
+
+	// Sum of the input values [l, r]
+	Acc RangeSumQuery(const int l, const int r) const
+	{
+		assert(0 <= l && l <= r && r < n);
+
+		Acc rsum = PrefixSum(r);
+		if(l > 0)
+			rsum -= PrefixSum(l-1);
+
+		return rsum;
+	}
+
+	int LowerBound(Acc prefix) const;
+};
+
+template<class T>
+FenwickTree(const std::vector<T>&) -> FenwickTree<T>;
+
+// O(n): each node adds itself to its parent once its own sum is complete.
+template<class T, class Acc>
+FenwickTree<T, Acc>::FenwickTree(std::span<const T> iv): n(iv.size()), v(iv.size() + 1)
+{
+	for(int k = 1; k <= n; ++k)
+	{
+		v[k] += iv[k-1];
+		const int parent = k + (k & -k);
+		if(parent <= n)
+			v[parent] += v[k];
+	}
+}
+
+// Smallest i with PrefixSum(i) >= prefix, size() if there is none. The input values must not be
+// negative, so that the prefix sums are sorted. The search descends the implicit tree from the
+// largest power of two not above n, taking a node whenever the sum so far stays below prefix.
+template<class T, class Acc>
+int FenwickTree<T, Acc>::LowerBound(Acc prefix) const
+{
+	int k = 0;
+	for(int step = n > 0 ? std::bit_floor(unsigned(n)) : 0; step > 0; step >>= 1)
+	{
+		if(k + step <= n && v[k + step] < prefix)
+		{
+			k += step;
+			prefix -= v[k];
+		}
+	}
+
+	return k;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef Platform_H
+#define Platform_H
+
+// CPU features and tuning constants shared by the data structures that pick a SIMD kernel at run
+// time or split their build across threads.
+
+// Widest instruction set the kernels can use on this CPU
+enum class SimdLevel
+{
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+inline SimdLevel detect_simd_level()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	if(__builtin_cpu_supports("avx2"))
+		return SimdLevel::AVX2;
+	if(__builtin_cpu_supports("sse2"))
+		return SimdLevel::SSE2;
+#endif
+	return SimdLevel::Scalar;
+}
+
+// Detected once; for the [[gnu::target("avx2")]] members of SparseTable and PrefixSumArray.
+inline bool has_avx2()
+{
+	static const bool avx2 = detect_simd_level() == SimdLevel::AVX2;
+	return avx2;
+}
+
+// Fewest elements a thread of a parallel build gets; smaller slices are not worth a thread.
+inline constexpr int min_parallel_slice = 1 << 16;
+
+#endif
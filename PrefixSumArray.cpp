@@ -1,35 +1,108 @@
 #include <iostream>
 #include <vector>
-#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
 #include <assert.h>
+#include "PrefixSumArray.h"
+#include "StreamingPrefixSumArray.h"
 
 using namespace std;
 
-class PrefixSumArray
+// Byte counters whose total exceeds 2^31: a 32 bit prefix sum would have wrapped.
+void overflow_test()
 {
-	vector<int> v;
-	
-	public:
-	
-	PrefixSumArray(vector<int>& iv): v(iv.size())
+	const int n = 3000000;
+	vector<int> v(n, 1000);
+	PrefixSumArray psa(v);
+
+	assert(psa.RangeSumQuery(0, n-1) == 3000000000ll);
+	assert(psa.RangeSumQuery(1, n-2) == 2999998000ll);
+	cout << "\nOverflow test: sum of " << n << " x 1000 = " << psa.RangeSumQuery(0, n-1) << endl;
+}
+
+// 0.1 is not representable, so every plain addition rounds; compensated summation keeps the prefix
+// sums within about one rounding of the exact ones.
+void kahan_test()
+{
+	const int n = 10000000;
+	vector<double> v(n, 0.1);
+	PrefixSumArray psa(v);
+
+	double plain = 0;
+	for(double x: v)
+		plain += x;
+
+	const double exact = n * 0.1L;
+	cout << "Kahan test: sum of " << n << " x 0.1, error plain = " << fabs(plain - exact)
+		<< ", compensated = " << fabs(psa.RangeSumQuery(0, n-1) - exact) << endl;
+	assert(fabs(psa.RangeSumQuery(0, n-1) - exact) <= 1e-9);
+}
+
+// The blocked parallel and SIMD scans must give the prefix sums of the serial loop.
+void parallel_test()
+{
+	const int n = 1000003;
+	mt19937 gen(1);
+	vector<int> vi(n);
+	vector<double> vd(n);
+	for(int i = 0; i < n; ++i)
 	{
-		if(iv.size() <= 0)
-			return;
-			
-		v[0] = iv[0];
-		for(int i=1;i<iv.size();++i)
-			v[i] = v[i-1] + iv[i];
+		vi[i] = int(gen());
+		vd[i] = (int(gen() % 2000000) - 1000000) / 7.0;
 	}
-	
-	int RangeSumQuery(const int l, const int r)
+
+	PrefixSumArray<int, int64_t> si(vi, 1), pi(vi, 4);
+	PrefixSumArray<double, double> sd(vd, 1), pd(vd, 4);
+	int64_t sum = 0;
+	for(int i = 0; i < n; ++i)
 	{
-		int rsum = v[r];
-		if(l > 0)
-			rsum -= v[l-1];
-			
-		return rsum;
+		sum += vi[i];
+		assert(si.PrefixSum(i) == sum && pi.PrefixSum(i) == sum);
+		assert(fabs(pd.PrefixSum(i) - sd.PrefixSum(i)) <= 1e-9 * max(1.0, fabs(sd.PrefixSum(i))));
 	}
-};
+
+	cout << "Parallel construction test successful" << endl;
+}
+
+// Ranges of the retained part of a stream against a PrefixSumArray over the whole stream, including
+// ranges starting at the oldest retained value and crossing block boundaries.
+void streaming_test()
+{
+	const int n = 100000;
+	mt19937 gen(3);
+	vector<int> vi(n);
+	vector<double> vd(n);
+	for(int i = 0; i < n; ++i)
+	{
+		vi[i] = int(gen() % 2000000000);
+		vd[i] = 1e6 + (gen() % 1000) / 7.0;
+	}
+
+	PrefixSumArray full_i(vi);
+	PrefixSumArray full_d(vd);
+	StreamingPrefixSumArray<int> si(10000);
+	StreamingPrefixSumArray<double> sd(10000);
+	for(int i = 0; i < n; ++i)
+	{
+		si.Append(vi[i]);
+		sd.Append(vd[i]);
+
+		assert(si.FirstRetained() == sd.FirstRetained());
+		assert(si.size() - si.FirstRetained() >= min<long long>(si.size(), 10000));
+		for(int q = 0; q < 3; ++q)
+		{
+			const long long first = si.FirstRetained();
+			long long l = q == 0 ? first : first + gen() % (i + 1 - first);
+			long long r = l + gen() % (i + 1 - l);
+			assert(si.RangeSumQuery(l, r) == full_i.RangeSumQuery(l, r));
+			[[maybe_unused]] const double expected = full_d.RangeSumQuery(l, r);
+			assert(fabs(sd.RangeSumQuery(l, r) - expected) <= 1e-9 * fabs(expected));
+		}
+	}
+
+	cout << "Streaming prefix sum test successful" << endl;
+}
 
 int main()
 {
@@ -40,9 +113,15 @@ int main()
 		vector<pair<int, int>> queries{ {3, 5}, {1, 4}, {0, 7} };
 		for(auto& q: queries)
 		{
-			int rsum = psa.RangeSumQuery(q.first, q.second);
+			auto rsum = psa.RangeSumQuery(q.first, q.second);
 			cout << "\nRange: [" << q.first << " " << q.second << "] sum = " << rsum << endl;
 		}
-		
+
+		overflow_test();
+		kahan_test();
+		parallel_test();
+		streaming_test();
+
+		// Timing of the builds and queries is in bench_prefix_sum.cpp.
 		return 0;	
 }
@@ -0,0 +1,266 @@
+#ifndef PrefixSumArray_H
+#define PrefixSumArray_H
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <cmath>
+#include <barrier>
+#include <thread>
+#include <assert.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "Platform.h"
+
+// Default accumulator of PrefixSumArray<T>: 64 bit integers for integral T, so that sums of
+// millions of 32 bit values cannot overflow, and double for floating point T (long double stays).
+template<class T>
+using PrefixSumType = std::conditional_t<std::is_integral_v<T>,
+	std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>,
+	std::conditional_t<(sizeof(T) > sizeof(double)), T, double>>;
+
+// Running sum in Acc. For a floating point Acc it is compensated (Kahan-Babuska / Neumaier): the
+// rounding error of every addition is carried in c and added back, so the sum stays within about
+// one rounding of the exact one instead of drifting by O(n) roundings. Compiling with -ffast-math
+// would let the compiler remove the compensation.
+template<class Acc>
+struct CompensatedSum
+{
+	Acc sum = 0;
+	Acc c = 0;
+
+	void Add(const Acc x)
+	{
+		if constexpr(std::is_floating_point_v<Acc>)
+		{
+			// c collects the low order bits lost by each rounded addition.
+			const Acc t = sum + x;
+			if(std::abs(sum) >= std::abs(x))
+				c += (sum - t) + x;
+			else
+				c += (x - t) + sum;
+			sum = t;
+		}
+		else
+			sum += x;
+	}
+
+	void Add(const CompensatedSum& s)
+	{
+		Add(s.sum);
+		Add(s.c);
+	}
+
+	Acc Value() const
+	{
+		return sum + c;
+	}
+};
+
+// Sums of ranges of a static array in O(1): v[i] holds the sum of the first i + 1 input values,
+// accumulated in Acc, and RangeSumQuery(l, r) is v[r] - v[l-1].
+//
+// A floating point Acc is accumulated with CompensatedSum, so each prefix is within about one
+// rounding of the exact sum. A range sum is the difference of two prefixes and so is exact to about
+// one unit in the last place of the larger prefix.
+template<class T = int, class Acc = PrefixSumType<T>>
+class PrefixSumArray
+{
+	static_assert(std::is_arithmetic_v<Acc>, "Acc must be an arithmetic type");
+
+	using Sum = CompensatedSum<Acc>;
+
+	int n;
+	std::unique_ptr<Acc[]> v;	// not value initialized: every element is written once by the scan
+
+	public:
+
+	// threads > 1 builds with a two pass blocked scan: the input is split into one slice per thread,
+	// each thread sums its slice, and after a barrier each one scans its slice starting from the
+	// sum of the slices before it. The input is read twice and the sums are written once.
+	// Sums of int into int64_t are computed 4 at a time with AVX2 when the CPU has it.
+	PrefixSumArray(const std::vector<T>& iv, const int threads = 1): PrefixSumArray(std::span<const T>(iv), threads) {}
+	PrefixSumArray(std::span<const T> iv, const int threads = 1);
+
+	int size() const
+	{
+		return n;
+	}
+
+	// Sum of the input values [0, i]
+	Acc PrefixSum(const int i) const
+	{
+		assert(0 <= i && i < size());
+		return v[i];
+	}
+
+	// Sum of the input values [l, r]
+	Acc RangeSumQuery(const int l, const int r) const
+	{
+		assert(0 <= l && l <= r && r < size());
+
+		Acc rsum = v[r];
+		if(l > 0)
+			rsum -= v[l-1];
+
+		return rsum;
+	}
+
+	private:
+
+	static constexpr bool simd_kernels = std::is_same_v<T, int> && std::is_same_v<Acc, int64_t>;
+
+	void BuildSlice(std::span<const T> iv, const int part, const int parts, std::vector<Sum>& totals, std::barrier<>* sync);
+	static Sum SliceSum(std::span<const T> in);
+	static void ScanSlice(std::span<const T> in, Acc* out, Sum s);
+
+#if defined(__x86_64__) || defined(__i386__)
+	[[gnu::target("avx2")]] static int64_t SumAVX2(const int* in, const size_t len);
+	[[gnu::target("avx2")]] static void ScanAVX2(const int* in, int64_t* out, const size_t len, int64_t carry);
+#endif
+};
+
+template<class T>
+PrefixSumArray(const std::vector<T>&) -> PrefixSumArray<T>;
+
+template<class T>
+PrefixSumArray(const std::vector<T>&, int) -> PrefixSumArray<T>;
+
+template<class T, class Acc>
+PrefixSumArray<T, Acc>::PrefixSumArray(std::span<const T> iv, const int threads): n(iv.size()), v(std::make_unique_for_overwrite<Acc[]>(iv.size()))
+{
+	const int parts = std::clamp(n / min_parallel_slice, 1, std::max(threads, 1));
+	if(parts == 1)
+	{
+		ScanSlice(iv, v.get(), Sum());
+		return;
+	}
+
+	std::vector<Sum> totals(parts);
+	std::barrier<> sync(parts);
+	std::vector<std::thread> workers;
+	for(int t = 1; t < parts; ++t)
+		workers.emplace_back([&, t] { BuildSlice(iv, t, parts, totals, &sync); });
+
+	BuildSlice(iv, 0, parts, totals, &sync);
+	for(auto& w: workers)
+		w.join();
+}
+
+// Sums slice part of the input into totals[part] and, once every slice is summed, writes the
+// prefix sums of the slice on top of the total of the slices before it. Each thread first touches
+// the output pages of its own slice.
+template<class T, class Acc>
+void PrefixSumArray<T, Acc>::BuildSlice(std::span<const T> iv, const int part, const int parts, std::vector<Sum>& totals, std::barrier<>* sync)
+{
+	const size_t first = size_t(n) * part / parts;
+	const size_t last = size_t(n) * (part + 1) / parts;
+	std::span<const T> in = iv.subspan(first, last - first);
+
+	totals[part] = SliceSum(in);
+	sync->arrive_and_wait();
+
+	Sum s;
+	for(int p = 0; p < part; ++p)
+		s.Add(totals[p]);
+
+	ScanSlice(in, v.get() + first, s);
+}
+
+template<class T, class Acc>
+typename PrefixSumArray<T, Acc>::Sum PrefixSumArray<T, Acc>::SliceSum(std::span<const T> in)
+{
+	Sum s;
+#if defined(__x86_64__) || defined(__i386__)
+	if constexpr(simd_kernels)
+	{
+		if(has_avx2())
+		{
+			s.sum = SumAVX2(in.data(), in.size());
+			return s;
+		}
+	}
+#endif
+
+	for(const T& x: in)
+		s.Add(x);
+	return s;
+}
+
+// out[i] = s + in[0] + ... + in[i]
+template<class T, class Acc>
+void PrefixSumArray<T, Acc>::ScanSlice(std::span<const T> in, Acc* out, Sum s)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	if constexpr(simd_kernels)
+	{
+		if(has_avx2())
+		{
+			ScanAVX2(in.data(), out, in.size(), s.sum);
+			return;
+		}
+	}
+#endif
+
+	for(size_t i = 0; i < in.size(); ++i)
+	{
+		s.Add(in[i]);
+		out[i] = s.Value();
+	}
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template<class T, class Acc>
+int64_t PrefixSumArray<T, Acc>::SumAVX2(const int* in, const size_t len)
+{
+	__m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+	size_t i = 0;
+	for(; i + 8 <= len; i += 8)
+	{
+		acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+		acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 4))));
+	}
+
+	alignas(32) int64_t lanes[4];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+	int64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	for(; i < len; ++i)
+		sum += in[i];
+
+	return sum;
+}
+
+// Scans 4 values in a register with two shifted adds. Only carry += total of the vector is on the
+// dependency chain from one vector to the next; the in-register scan and the broadcast of its last
+// lane are not, so consecutive vectors overlap.
+template<class T, class Acc>
+void PrefixSumArray<T, Acc>::ScanAVX2(const int* in, int64_t* out, const size_t len, int64_t carry)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i vcarry = _mm256_set1_epi64x(carry);
+	size_t i = 0;
+	for(; i + 4 <= len; i += 4)
+	{
+		__m256i x = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+		// [a, b, c, d] + [0, a, b, c] + [0, 0, a, a+b]
+		x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+		x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi64(x, vcarry));
+		vcarry = _mm256_add_epi64(vcarry, _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3)));
+	}
+
+	carry = _mm256_extract_epi64(vcarry, 0);
+	for(; i < len; ++i)
+	{
+		carry += in[i];
+		out[i] = carry;
+	}
+}
+#endif
+
+#endif
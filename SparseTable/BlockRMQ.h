@@ -0,0 +1,118 @@
+#ifndef BlockRMQ_H
+#define BlockRMQ_H
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <cstdint>
+#include <assert.h>
+#include <bit>
+#include "SparseTable.h"
+
+// Range minimum query in O(n) memory and O(1) time, a drop-in for SparseTable<T, MinOp>.
+// The input is cut into blocks of 32 elements. A SparseTable over the block minima answers the
+// whole blocks of a query; the partial blocks at its ends are answered from one 32-bit mask per
+// element: bit j of mask[i] is set when i - j is on the monotonic stack of the minima ending at i
+// within its block, so the minimum of [l, i] is at the highest set bit of mask[i] below i - l + 1.
+// Memory is sizeof(T) + 4 bytes per element (plus padding) and about sizeof(T) * log2(n / 32) / 32
+// for the table of block minima.
+template<class T = int>
+class BlockRMQ
+{
+	static constexpr int block_bits = 5;
+	static constexpr int block_size = 1 << block_bits;
+
+	// Values and masks are interleaved so that a partial block usually costs a single cache miss.
+	struct Cell
+	{
+		T value;
+		uint32_t mask;
+	};
+
+	const int n;
+	std::vector<Cell> cells;
+	SparseTable<T, MinOp> blocks;
+
+	public:
+
+		BlockRMQ(const std::vector<T>& iv): BlockRMQ(std::span<const T>(iv)) {}
+		BlockRMQ(std::span<const T> iv);
+
+		T Min(const int beg, const int end) const;
+
+		// Bytes held by the structure, for comparison with SparseTable::MemoryBytes
+		size_t MemoryBytes() const
+		{
+			return cells.capacity() * sizeof(Cell) + blocks.MemoryBytes();
+		}
+
+	private:
+
+		T InBlockMin(const int beg, const int end) const;
+		static std::vector<T> BlockMinima(std::span<const T> iv);
+};
+
+template<class T>
+BlockRMQ(const std::vector<T>&) -> BlockRMQ<T>;
+
+template<class T>
+BlockRMQ<T>::BlockRMQ(std::span<const T> iv): n(iv.size()), cells(iv.size()), blocks(BlockMinima(iv))
+{
+	uint32_t cur = 0;
+	for(int i = 0; i < n; ++i)
+	{
+		if((i & (block_size - 1)) == 0)
+			cur = 0;
+
+		// Shift the stack one position further from i and pop the entries not smaller than iv[i].
+		cur <<= 1;
+		while(cur != 0 && !(iv[i - std::countr_zero(cur)] < iv[i]))
+			cur &= cur - 1;
+
+		cur |= 1;
+		cells[i] = {iv[i], cur};
+	}
+}
+
+template<class T>
+std::vector<T> BlockRMQ<T>::BlockMinima(std::span<const T> iv)
+{
+	std::vector<T> mins((iv.size() + block_size - 1) >> block_bits);
+	for(size_t b = 0; b < mins.size(); ++b)
+	{
+		const size_t beg = b << block_bits;
+		const size_t end = std::min(iv.size(), beg + block_size);
+		mins[b] = *std::min_element(iv.begin() + beg, iv.begin() + end);
+	}
+
+	return mins;
+}
+
+template<class T>
+T BlockRMQ<T>::Min(const int beg, const int end) const
+{
+	assert(beg >= 0);
+	assert(end >= beg);
+	assert(end < n);
+
+	const int bb = beg >> block_bits;
+	const int be = end >> block_bits;
+	if(bb == be)
+		return InBlockMin(beg, end);
+
+	T mn = std::min(InBlockMin(beg, ((bb + 1) << block_bits) - 1), InBlockMin(be << block_bits, end));
+	if(be - bb > 1)
+		mn = std::min(mn, blocks.Min(bb + 1, be - 1));
+
+	return mn;
+}
+
+// [beg, end] lies within one block; keep the stack entries of end that are at or after beg.
+template<class T>
+T BlockRMQ<T>::InBlockMin(const int beg, const int end) const
+{
+	const uint32_t m = cells[end].mask & (~0u >> (block_size - 1 - (end - beg)));
+	return cells[end - (std::bit_width(m) - 1)].value;
+}
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef DynamicRangeQuery_H
+#define DynamicRangeQuery_H
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <assert.h>
+
+// Min and max range queries over a sequence that can be updated and appended to, in O(log n) per
+// operation.
+//
+// The elements are kept in one contiguous array cut into blocks of 16, and an iterative bottom-up
+// segment tree is built over the (min, max) of each block: node k has children 2k and 2k+1 and the
+// leaves are nodes [cap, 2 * cap). A query scans the two partial blocks at its ends and walks the
+// tree for the whole blocks in between; an update rescans its block and recomputes one path.
+// The tree is 16 times smaller than one over single elements, which removes the four deepest,
+// cache-missing levels of every walk for the price of scanning one or two cache lines per block.
+// Min and max of a node share a cache line since updates and MinMax need both.
+//
+// When the tree is full PushBack doubles its capacity and rebuilds it in O(n / 16).
+template<class T = int>
+class DynamicRangeQuery
+{
+	static constexpr int block_bits = 4;
+	static constexpr int block_size = 1 << block_bits;
+
+	struct Node
+	{
+		T mn;
+		T mx;
+	};
+
+	static constexpr Node identity = {std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest()};
+
+	std::vector<T> v;
+	int cap = 1;	// number of leaves of the tree, a power of two >= number of blocks
+	std::vector<Node> t = std::vector<Node>(2, identity);
+
+	public:
+
+		DynamicRangeQuery() {}
+		DynamicRangeQuery(const std::vector<T>& iv): DynamicRangeQuery(std::span<const T>(iv)) {}
+		DynamicRangeQuery(std::span<const T> iv);
+
+		int size() const
+		{
+			return v.size();
+		}
+
+		T Get(const int i) const
+		{
+			assert(0 <= i && i < size());
+			return v[i];
+		}
+
+		void Update(const int i, const T& value);
+		void PushBack(const T& value);
+
+		T Min(const int beg, const int end) const
+		{
+			return MinMax(beg, end).first;
+		}
+
+		T Max(const int beg, const int end) const
+		{
+			return MinMax(beg, end).second;
+		}
+
+		// Returns {min, max} of [beg, end]
+		std::pair<T, T> MinMax(const int beg, const int end) const;
+
+	private:
+
+		static Node Combine(const Node& a, const Node& b)
+		{
+			return {std::min(a.mn, b.mn), std::max(a.mx, b.mx)};
+		}
+
+		Node Scan(const int beg, const int end) const;
+		Node BlockNode(const int b) const;
+		void UpdatePath(const int b);
+		void Rebuild(const int new_cap);
+};
+
+template<class T>
+DynamicRangeQuery(const std::vector<T>&) -> DynamicRangeQuery<T>;
+
+template<class T>
+DynamicRangeQuery<T>::DynamicRangeQuery(std::span<const T> iv): v(iv.begin(), iv.end())
+{
+	const int blocks = (size() + block_size - 1) >> block_bits;
+	int c = 1;
+	while(c < blocks)
+		c <<= 1;
+
+	Rebuild(c);
+}
+
+template<class T>
+void DynamicRangeQuery<T>::Update(const int i, const T& value)
+{
+	assert(0 <= i && i < size());
+
+	v[i] = value;
+	UpdatePath(i >> block_bits);
+}
+
+template<class T>
+void DynamicRangeQuery<T>::PushBack(const T& value)
+{
+	v.push_back(value);
+
+	const int b = (size() - 1) >> block_bits;
+	if(b == cap)
+		Rebuild(2 * cap);
+	else
+		UpdatePath(b);
+}
+
+template<class T>
+std::pair<T, T> DynamicRangeQuery<T>::MinMax(const int beg, const int end) const
+{
+	assert(0 <= beg && beg <= end && end < size());
+
+	const int bb = beg >> block_bits;
+	const int be = end >> block_bits;
+	if(bb == be)
+	{
+		const Node res = Scan(beg, end);
+		return {res.mn, res.mx};
+	}
+
+	Node res = Combine(Scan(beg, ((bb + 1) << block_bits) - 1), Scan(be << block_bits, end));
+
+	// Walks up from both ends of the whole blocks; a node is taken when the range boundary cuts its parent.
+	for(int l = bb + 1 + cap, r = be + cap; l < r; l >>= 1, r >>= 1)
+	{
+		if(l & 1)
+			res = Combine(res, t[l++]);
+		if(r & 1)
+			res = Combine(res, t[--r]);
+	}
+
+	return {res.mn, res.mx};
+}
+
+template<class T>
+typename DynamicRangeQuery<T>::Node DynamicRangeQuery<T>::Scan(const int beg, const int end) const
+{
+	T lo = v[beg], hi = v[beg];
+	for(int i = beg + 1; i <= end; ++i)
+	{
+		lo = std::min(lo, v[i]);
+		hi = std::max(hi, v[i]);
+	}
+
+	return {lo, hi};
+}
+
+template<class T>
+typename DynamicRangeQuery<T>::Node DynamicRangeQuery<T>::BlockNode(const int b) const
+{
+	const int beg = b << block_bits;
+	if(beg >= size())
+		return identity;
+
+	return Scan(beg, std::min(size(), beg + block_size) - 1);
+}
+
+// Recomputes the leaf of block b and its ancestors.
+template<class T>
+void DynamicRangeQuery<T>::UpdatePath(const int b)
+{
+	int k = cap + b;
+	t[k] = BlockNode(b);
+	for(k >>= 1; k > 0; k >>= 1)
+		t[k] = Combine(t[2*k], t[2*k+1]);
+}
+
+// Builds the tree with new_cap leaves from the blocks of v.
+template<class T>
+void DynamicRangeQuery<T>::Rebuild(const int new_cap)
+{
+	assert(new_cap << block_bits >= size());
+
+	cap = new_cap;
+	t.assign(2 * cap, identity);
+	for(int b = 0; b < cap; ++b)
+		t[cap + b] = BlockNode(b);
+
+	for(int k = cap - 1; k > 0; --k)
+		t[k] = Combine(t[2*k], t[2*k+1]);
+}
+
+#endif
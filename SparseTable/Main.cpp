@@ -1,4 +1,6 @@
 #include "SparseTable.h"
+#include "BlockRMQ.h"
+#include "MappedSparseTable.h"
 #include <vector>
 #include <algorithm>
 #include <functional>
@@ -6,8 +8,11 @@
 #include <iostream>
 #include <assert.h>
 #include <time.h>
-#include <chrono>
 #include <stdlib.h>
+#include <stdexcept>
+#include <cstdio>
+#include <fstream>
+#include <filesystem>
 
 void Generate(std::vector<int>& v)
 {
@@ -17,20 +22,172 @@ void Generate(std::vector<int>& v)
 		v[I] = rand() % 10000;
 }
 
-void time_test(std::vector<int>& v, std::function<int(int, int)> fn, std::string msg)
+// Compares every query of SparseTable<T, Op> over n random values with a naive fold of the range.
+template<class T, class Op>
+void validate_op(const int n, T (*gen)(int))
 {
-	auto start = std::chrono::steady_clock::now();
+	std::vector<T> v(n);
+	for(int I = 0; I < n; ++I)
+		v[I] = gen(I);
 
-	const int sz = v.size();
-	int mn;
-	for(int I = 0; I < sz; ++I)
-		for(int J = I; J < sz; ++J)
-			mn = fn(I, J);
+	SparseTable<T, Op> st(v);
+	Op op;
+	for(int I = 0; I < n; ++I)
+	{
+		T acc = v[I];
+		for(int J = I; J < n; ++J)
+		{
+			acc = op(acc, v[J]);
+			assert(st.Query(I, J) == acc);
+		}
+	}
+
+	// QueryBatch over every range, including a tail shorter than one vector.
+	std::vector<std::pair<int, int>> queries;
+	for(int I = 0; I < n; ++I)
+		for(int J = I; J < n; ++J)
+			queries.push_back({I, J});
+	queries.pop_back();
+
+	std::vector<T> out(queries.size());
+	st.QueryBatch(queries, out);
+	for(size_t I = 0; I < queries.size(); ++I)
+		assert(out[I] == st.Query(queries[I].first, queries[I].second));
+}
+
+void generic_test()
+{
+	validate_op<int, MinOp>(300, [](int) { return rand() - RAND_MAX / 2; });
+	validate_op<int, MaxOp>(300, [](int) { return rand() - RAND_MAX / 2; });
+	validate_op<long long, MaxOp>(300, [](int) { return (long long)rand() * rand(); });
+	validate_op<double, MinOp>(300, [](int) { return rand() / 7.0; });
+	validate_op<int, GcdOp>(300, [](int) { return 6 * (1 + rand() % 1000); });
+	validate_op<unsigned, BitAndOp>(300, [](int) { return (unsigned)rand() | 0x80000000u; });
+	validate_op<unsigned, BitOrOp>(300, [](int) { return 1u << (rand() % 32); });
+
+	// argmin: minimum over (value, index) pairs
+	std::vector<std::pair<int, int>> v{{5, 0}, {2, 1}, {7, 2}, {2, 3}, {9, 4}};
+	SparseTable<std::pair<int, int>> argmin(v);
+	assert(argmin.Query(0, 4).second == 1);
+	assert(argmin.Query(2, 4).second == 3);
+
+	std::cout << "\nGeneric Sparse Table tests successful\n";
+}
+
+// Compares every query of BlockRMQ with SparseTable, for sizes around the block boundaries.
+void block_rmq_test()
+{
+	for(const int n: {1, 2, 31, 32, 33, 64, 100, 300})
+	{
+		std::vector<int> v(n);
+		for(int& x: v)
+			x = rand() % 50;
+
+		SparseTable st(v);
+		BlockRMQ brmq(v);
+		for(int I = 0; I < n; ++I)
+			for(int J = I; J < n; ++J)
+				assert(brmq.Min(I, J) == st.Min(I, J));
+	}
+
+	std::cout << "\nBlockRMQ tests successful\n";
+}
+
+// Checks that SparseTable built in parallel with 2 to 4 threads answers random queries like the
+// serial build. n is large enough for several build slices.
+void parallel_build_test()
+{
+	const int n = 300000;
+	std::vector<int> v(n);
+	Generate(v);
+
+	SparseTable serial(v);
+	for(int threads = 2; threads <= 4; ++threads)
+	{
+		SparseTable st(v, threads);
+		for(int I = 0; I < 100000; ++I)
+		{
+			int b = rand() % n;
+			int e = rand() % n;
+			if(b > e)
+				std::swap(b, e);
+			assert(st.Min(b, e) == serial.Min(b, e));
+		}
+	}
 
-	auto end = std::chrono::steady_clock::now();
-	auto tm = std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count();
+	std::cout << "\nParallel Sparse Table build tests successful\n";
+}
+
+// Saves a SparseTable, maps it back and compares every query; then checks that files of another
+// type or with damaged contents are rejected, and that a mapped file can be saved over.
+void mapped_test()
+{
+	std::vector<int> v(1000);
+	Generate(v);
+	const std::string path = (std::filesystem::temp_directory_path() / "sparse_table_test.spt").string();
+
+	SparseTable st(v);
+	MappedSparseTable<int>::Save(st, path);
+	{
+		MappedSparseTable<int> mst(path);
+		MappedSparseTable<int> verified(path, true);
+		const int n = v.size();
+		assert(mst.size() == n);
+		for(int I = 0; I < n; ++I)
+			for(int J = I; J < n; ++J)
+				assert(mst.Min(I, J) == st.Min(I, J) && verified.Min(I, J) == st.Min(I, J));
+	}
 
-	std::cout << "\n" << msg << tm << " milli-seconds" << std::endl;
+	// A table saved for another operation or element type is rejected.
+	bool rejected = false;
+	try
+	{
+		MappedSparseTable<int, MaxOp> wrong(path);
+	}
+	catch(const std::runtime_error&)
+	{
+		rejected = true;
+	}
+	assert(rejected);
+
+	// So is a table whose contents were damaged, when the checksum is verified.
+	{
+		std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+		f.seekp(-1, std::ios::end);
+		f.put('\x7f');
+	}
+	rejected = false;
+	try
+	{
+		MappedSparseTable<int> damaged(path, true);
+	}
+	catch(const std::runtime_error&)
+	{
+		rejected = true;
+	}
+	assert(rejected);
+
+	// Saving over a mapped file replaces it: the old mapping keeps the old table, a new open sees the new one.
+	{
+		MappedSparseTable<int>::Save(SparseTable(std::vector<int>{5, 3, 8}), path);
+		MappedSparseTable<int> old_table(path);
+		MappedSparseTable<int>::Save(SparseTable(std::vector<int>{1, 9}), path);
+		assert(old_table.size() == 3 && old_table.Min(0, 2) == 3);
+
+		std::vector<MappedSparseTable<int>> tables;
+		tables.push_back(MappedSparseTable<int>(path));
+		tables.push_back(std::move(old_table));
+		assert(old_table.size() == 0);
+		assert(tables[0].size() == 2 && tables[0].Min(0, 1) == 1);
+		assert(tables[1].Min(1, 2) == 3);
+
+		tables[0] = std::move(tables[1]);
+		assert(tables[0].size() == 3 && tables[1].size() == 0);
+	}
+
+	std::remove(path.c_str());
+
+	std::cout << "\nMapped Sparse Table tests successful\n";
 }
 
 void validate(std::vector<int>& v, std::function<int(int,int)> fun1, std::function<int(int,int)> fun2)
@@ -60,28 +217,25 @@ int main()
 
 	std::cout << "\nBasic Test for Range Minimum query using Sparse Table successful\n";
 
-	int n;
-	std::cout << std::endl << "Enter size: ";
-	std::cout.flush();
-	std::cin >> n;
+	generic_test();
+	block_rmq_test();
+	parallel_build_test();
+	mapped_test();
 
-	std::vector<int> v1(n);
+	// Timing of the queries, the builds and the mapped tables is in bench_range_query.cpp.
+	std::vector<int> v1(2000);
 	Generate(v1);
 
 	auto naive_fn = [&v1](const int b, const int e)->int{
 		return *std::min_element(v1.begin()+b, v1.begin()+e+1);
 	};
 
-	time_test(v1, naive_fn, "Time with naive approach = ");
-
 	SparseTable st1(v1);
 
 	auto st_fn = [&st1](const int b, const int e)->int{
 		return st1.Min(b, e);
 	};
 
-	time_test(v1, st_fn, "Time with Sparse Table = ");
-
 	validate(v1, naive_fn, st_fn);
 
 	std::cout << "\nValidation for Sparse Table successful" << std::endl;
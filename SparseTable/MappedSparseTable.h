@@ -0,0 +1,294 @@
+#ifndef MappedSparseTable_H
+#define MappedSparseTable_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <assert.h>
+#include <bit>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SparseTable.h"
+
+// Read-only SparseTable answered directly from a memory mapped file written by Save.
+//
+//	MappedSparseTable<int>::Save(SparseTable(values), "values.spt");	// once, e.g. at data build time
+//	MappedSparseTable<int> st("values.spt");	// at startup: one mmap, nothing is built or copied
+//	int mn = st.Min(beg, end);
+//
+// The file is a 64 byte header, the row offsets and then the flat table, padded so that the table
+// starts on a 64 byte boundary. Pages are read lazily and shared between the processes mapping the
+// same file. The header records the element size and the operation, so a table of another type is
+// rejected; the format is native endian and is not meant to be moved between architectures.
+// The FNV-1a checksum of offsets and table is only verified on request since that reads the whole file.
+template<class T = int, class Op = MinOp>
+class MappedSparseTable
+{
+	static_assert(std::is_trivially_copyable_v<T>, "MappedSparseTable stores the raw bytes of its elements");
+	static_assert(alignof(T) <= 64, "the table starts on a 64 byte boundary");
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t element_size;
+		uint64_t n;
+		uint32_t levels;
+		char op[12];
+		uint64_t table_offset;
+		uint64_t table_size;
+		uint64_t checksum;
+	};
+
+	static_assert(sizeof(Header) == 64);
+	static_assert(sizeof(Op::name) <= sizeof(Header::op));
+
+	static constexpr char file_magic[8] = {'S', 'P', 'T', 'A', 'B', 'L', 'E', '\0'};
+	static constexpr uint32_t file_version = 2;	// 2: 64 bit row offsets
+
+	int n = 0;
+	const int64_t* offset = nullptr;
+	const T* v = nullptr;
+	char* map = nullptr;
+	size_t map_bytes = 0;
+	[[no_unique_address]] Op op;
+
+	public:
+
+		MappedSparseTable(const std::string& path, const bool verify_checksum = false);
+
+		MappedSparseTable(const MappedSparseTable&) = delete;
+		MappedSparseTable& operator=(const MappedSparseTable&) = delete;
+
+		// The moved from table is left empty.
+		MappedSparseTable(MappedSparseTable&& other) noexcept
+			: n(std::exchange(other.n, 0)), offset(std::exchange(other.offset, nullptr)), v(std::exchange(other.v, nullptr)),
+			  map(std::exchange(other.map, nullptr)), map_bytes(std::exchange(other.map_bytes, 0))
+		{
+		}
+
+		MappedSparseTable& operator=(MappedSparseTable&& other) noexcept
+		{
+			if(this != &other)
+			{
+				if(map != nullptr)
+					::munmap(map, map_bytes);
+				n = std::exchange(other.n, 0);
+				offset = std::exchange(other.offset, nullptr);
+				v = std::exchange(other.v, nullptr);
+				map = std::exchange(other.map, nullptr);
+				map_bytes = std::exchange(other.map_bytes, 0);
+			}
+			return *this;
+		}
+
+		~MappedSparseTable()
+		{
+			if(map != nullptr)
+				::munmap(map, map_bytes);
+		}
+
+		// Writes st to path in the format read by the constructor. The file is written to a temporary
+		// in the same directory, synced and renamed over path, so processes that still map the old
+		// file keep reading it intact and a new open sees either the old or the new table.
+		static void Save(const SparseTable<T, Op>& st, const std::string& path);
+
+		int size() const
+		{
+			return n;
+		}
+
+		T Query(const int beg, const int end) const;
+
+		T Min(const int beg, const int end) const requires std::same_as<Op, MinOp>
+		{
+			return Query(beg, end);
+		}
+
+	private:
+
+		static uint64_t Checksum(const char* data, const size_t bytes, uint64_t hash = 14695981039346656037ull);
+		static size_t TableOffset(const size_t levels);
+		static void WriteAll(const int fd, const char* data, size_t bytes, const std::string& path);
+};
+
+template<class T, class Op>
+MappedSparseTable<T, Op>::MappedSparseTable(const std::string& path, const bool verify_checksum)
+{
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw std::system_error(errno, std::generic_category(), "open " + path);
+
+	struct stat st;
+	if(::fstat(fd, &st) != 0)
+	{
+		const int err = errno;
+		::close(fd);
+		throw std::system_error(err, std::generic_category(), "fstat " + path);
+	}
+
+	map_bytes = static_cast<size_t>(st.st_size);
+	if(map_bytes < sizeof(Header))
+	{
+		::close(fd);
+		throw std::runtime_error(path + " is not a sparse table file");
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	void* p = ::mmap(nullptr, map_bytes, PROT_READ, MAP_SHARED, fd, 0);
+	const int err = errno;
+	::close(fd);
+	if(p == MAP_FAILED)
+		throw std::system_error(err, std::generic_category(), "mmap " + path);
+	map = static_cast<char*>(p);
+
+	Header h;
+	std::memcpy(&h, map, sizeof(Header));
+	char op_name[sizeof(h.op)] = {};
+	std::memcpy(op_name, Op::name, sizeof(Op::name));
+
+	bool valid = std::memcmp(h.magic, file_magic, sizeof(file_magic)) == 0 && h.version == file_version
+		&& h.element_size == sizeof(T) && std::memcmp(h.op, op_name, sizeof(op_name)) == 0
+		&& h.n <= uint64_t(INT32_MAX) && h.levels == uint32_t(std::bit_width(h.n))
+		&& h.table_offset == TableOffset(h.levels) && h.table_offset <= map_bytes
+		&& h.table_size <= (map_bytes - h.table_offset) / sizeof(T);
+
+	// The row layout follows from n, so checking it here keeps every query inside the mapping.
+	uint64_t rows = 0;
+	for(uint32_t i = 0; valid && i < h.levels; ++i)
+	{
+		int64_t off;
+		std::memcpy(&off, map + sizeof(Header) + i * sizeof(int64_t), sizeof(off));
+		valid = off == int64_t(rows);
+		rows += h.n - (uint64_t(1) << i) + 1;
+	}
+	valid = valid && rows == h.table_size;
+
+	if(!valid)
+	{
+		::munmap(map, map_bytes);
+		map = nullptr;
+		throw std::runtime_error(path + " is not a sparse table file of this element type and operation");
+	}
+
+	n = static_cast<int>(h.n);
+	offset = reinterpret_cast<const int64_t*>(map + sizeof(Header));
+	v = reinterpret_cast<const T*>(map + h.table_offset);
+
+	if(verify_checksum)
+	{
+		uint64_t hash = Checksum(map + sizeof(Header), h.levels * sizeof(int64_t));
+		hash = Checksum(map + h.table_offset, h.table_size * sizeof(T), hash);
+		if(hash != h.checksum)
+		{
+			::munmap(map, map_bytes);
+			map = nullptr;
+			throw std::runtime_error(path + " is corrupt: checksum mismatch");
+		}
+	}
+}
+
+template<class T, class Op>
+void MappedSparseTable<T, Op>::Save(const SparseTable<T, Op>& st, const std::string& path)
+{
+	Header h = {};
+	std::memcpy(h.magic, file_magic, sizeof(file_magic));
+	std::memcpy(h.op, Op::name, sizeof(Op::name));
+	h.version = file_version;
+	h.element_size = sizeof(T);
+	h.n = st.n;
+	h.levels = st.offset.size();
+	h.table_offset = TableOffset(h.levels);
+	h.table_size = st.v.size();
+
+	const char* offsets = reinterpret_cast<const char*>(st.offset.data());
+	const char* table = reinterpret_cast<const char*>(st.v.data());
+	h.checksum = Checksum(table, h.table_size * sizeof(T), Checksum(offsets, h.levels * sizeof(int64_t)));
+
+	std::string tmp = path + ".XXXXXX";
+	const int fd = ::mkstemp(tmp.data());
+	if(fd < 0)
+		throw std::system_error(errno, std::generic_category(), "create temporary file for " + path);
+
+	try
+	{
+		const char padding[64] = {};
+		WriteAll(fd, reinterpret_cast<const char*>(&h), sizeof(h), tmp);
+		WriteAll(fd, offsets, h.levels * sizeof(int64_t), tmp);
+		WriteAll(fd, padding, h.table_offset - sizeof(Header) - h.levels * sizeof(int64_t), tmp);
+		WriteAll(fd, table, h.table_size * sizeof(T), tmp);
+		// mkstemp creates the file readable by its owner only.
+		if(::fchmod(fd, 0644) != 0 || ::fsync(fd) != 0)
+			throw std::system_error(errno, std::generic_category(), "sync " + tmp);
+	}
+	catch(...)
+	{
+		::close(fd);
+		::unlink(tmp.c_str());
+		throw;
+	}
+
+	if(::close(fd) != 0 || ::rename(tmp.c_str(), path.c_str()) != 0)
+	{
+		const int err = errno;
+		::unlink(tmp.c_str());
+		throw std::system_error(err, std::generic_category(), "replace " + path);
+	}
+}
+
+template<class T, class Op>
+T MappedSparseTable<T, Op>::Query(const int beg, const int end) const
+{
+	assert(beg >= 0);
+	assert(beg <= end);
+	assert(end < n);
+
+	const int p = std::bit_width(static_cast<unsigned>(end - beg + 1)) - 1;
+	const int64_t ind = offset[p];
+	return op(v[ind + beg], v[ind + end - (1 << p) + 1]);
+}
+
+template<class T, class Op>
+uint64_t MappedSparseTable<T, Op>::Checksum(const char* data, const size_t bytes, uint64_t hash)
+{
+	for(size_t i = 0; i < bytes; ++i)
+	{
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+template<class T, class Op>
+void MappedSparseTable<T, Op>::WriteAll(const int fd, const char* data, size_t bytes, const std::string& path)
+{
+	while(bytes > 0)
+	{
+		const ssize_t written = ::write(fd, data, bytes);
+		if(written < 0 && errno == EINTR)
+			continue;
+		if(written <= 0)
+			throw std::system_error(errno, std::generic_category(), "write " + path);
+		data += written;
+		bytes -= written;
+	}
+}
+
+// The offsets follow the header and the table starts at the next multiple of 64 bytes.
+template<class T, class Op>
+size_t MappedSparseTable<T, Op>::TableOffset(const size_t levels)
+{
+	return (sizeof(Header) + levels * sizeof(int64_t) + 63) & ~size_t(63);
+}
+
+#endif
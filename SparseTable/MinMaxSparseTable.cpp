@@ -4,128 +4,26 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <time.h>
+#include "StaticRangeQuery.h"
+#include "MinMaxSparseTable.h"
+#include "DynamicRangeQuery.h"
+#include "SlidingWindowRangeQuery.h"
 
 using namespace std;
 
-class StaticRangeQuery
-{
-	const int n;
-	vector<pair<int, int>> v;
-	
-	public:
-	StaticRangeQuery(vector<int>& iv) : n(iv.size())
-	{
-		int p = Log2(n);
-		int sz = GetCumSize(p);
-		
-		v.resize(sz);
-		for(int i=0;i<n;++i)
-			v[i] = {iv[i], iv[i]};
-		
-		int beg=0, end=n;
-		std::pair<int, int> val1, val2;
-		for(int i=1;i<=p;++i)
-		{
-			sz = n - (1 << i) + 1;
-			for(int j=0;j<sz;++j)
-			{
-				val1 = v[beg+j];
-				val2 = v[beg+j+(1<<(i-1))];
-				v[end+j] = {std::min(val1.first, val2.first), std::max(val1.second, val2.second)};
-			}
-			
-			beg = end;
-			end += sz;
-		}
-	}
-	
-	int size()
-	{
-		return n;
-	}
-	
-	int Log2(const int num)
-	{
-		int p=-1;
-		while( (1<<(p+1)) <= num)
-			++p;
-		return p;
-	}
-	
-	int GetCumSize(const int p)
-	{
-		int sz = 0;
-		for(int i=0;i<=p;++i)
-			sz += (n-(1<<i)+1);
-		return sz;
-	}
-	
-	std::pair<int, int> GetIndices(const int beg, const int end)
-	{
-		assert(0 <= beg);
-		assert(beg < n);
-		assert(beg <= end);
-		assert(0 <= end);
-		assert(end < n);
-
-		if(beg == end)
-			return {beg, end};
-
-		int sz = end - beg + 1;
-		int p = Log2(sz);
-		int ind = GetCumSize(p-1);
-		int b = ind+beg;
-		int e = ind+end-(1<<p)+1;
-		return {b, e};
-	}
-	
-	int Min(const int beg, const int end)
-	{
-		auto pr = GetIndices(beg, end);
-		int ans = v[pr.first].first;
-		if(pr.first != pr.second)
-			ans = std::min(ans, v[pr.second].first);
-		
-		return ans;
-	}
-	
-	int Max(const int beg, const int end)
-	{
-		auto pr = GetIndices(beg, end);
-		int ans = v[pr.first].second;
-		if(pr.first != pr.second)
-			ans = std::max(ans, v[pr.second].second);
-		
-		return ans;
-	}
-	
-	void print()
-	{
-		cout << "\n [ ";
-		for(int i=0;i<n;++i)
-			cout << v[i].first << " ";
-		cout << "]\n";
-		
-		cout << "\nMin: " << v.size() << " [ ";
-		for(const auto& i: v)
-			cout << i.first << " ";
-		cout << "]\n";
-		
-		cout << "\nMax: " << v.size() << " [ ";
-		for(const auto& i: v)
-			cout << i.second<< " ";
-		cout << "]\n";
-	}
-};
-
 void test(StaticRangeQuery& srq, vector<int>& v)
 {
-	for(int i=0;i<v.size();++i)
+	// The expected min and max of [i, j] are carried along j instead of rescanning the range.
+	const int sz = v.size();
+	for(int i=0;i<sz;++i)
 	{
-		for(int j=i;j<v.size();++j)
+		int mn2 = v[i], mx2 = v[i];
+		for(int j=i;j<sz;++j)
 		{
+			mn2 = std::min(mn2, v[j]);
+			mx2 = std::max(mx2, v[j]);
+
 			int mn1 = srq.Min(i, j);
-			int mn2 = *std::min_element(v.begin()+i, v.begin()+j+1);
 			if(mn1 != mn2)
 			{
 				srq.print();
@@ -136,7 +34,6 @@ void test(StaticRangeQuery& srq, vector<int>& v)
 			}
 			
 			int mx1 = srq.Max(i, j);
-			int mx2 = *std::max_element(v.begin()+i, v.begin()+j+1);
 			if(mx1 != mx2)
 			{
 				srq.print();
@@ -166,15 +63,98 @@ void test()
 		Generate(v);
 		StaticRangeQuery srq(v);
 		test(srq, v);
+
+		MinMaxSparseTable mmst(v);
+		const int n = v.size();
+		for(int b=0;b<n;++b)
+			for(int e=b;e<n;++e)
+			{
+				[[maybe_unused]] auto mm = mmst.MinMax(b, e);
+				assert(mm.first == srq.Min(b, e) && mm.first == mmst.Min(b, e));
+				assert(mm.second == srq.Max(b, e) && mm.second == mmst.Max(b, e));
+			}
 	}
 	
 	cout << "\nStatic Range Query successful !!!";
 }
 
+// Random updates, appends and queries on DynamicRangeQuery checked against a plain vector.
+void dynamic_test()
+{
+	vector<int> v(1 + rand() % 100);
+	for(auto& x: v)
+		x = rand() % 1000;
+
+	DynamicRangeQuery drq(v);
+	for(int op=0;op<200000;++op)
+	{
+		const int kind = rand() % 10;
+		if(kind == 0)
+		{
+			v.push_back(rand() % 1000);
+			drq.PushBack(v.back());
+		}
+		else if(kind < 4)
+		{
+			const int i = rand() % v.size();
+			v[i] = rand() % 1000;
+			drq.Update(i, v[i]);
+		}
+		else
+		{
+			int b = rand() % v.size();
+			int e = rand() % v.size();
+			if(b > e)
+				swap(b, e);
+			[[maybe_unused]] auto mm = drq.MinMax(b, e);
+			assert(mm.first == *min_element(v.begin()+b, v.begin()+e+1) && mm.first == drq.Min(b, e));
+			assert(mm.second == *max_element(v.begin()+b, v.begin()+e+1) && mm.second == drq.Max(b, e));
+		}
+	}
+
+	DynamicRangeQuery<int> empty;
+	for(int i=0;i<100;++i)
+	{
+		empty.PushBack(100 - i);
+		assert(empty.size() == i + 1 && empty.Min(0, i) == 100 - i && empty.Max(0, i) == 100 && empty.Get(i) == 100 - i);
+	}
+
+	cout << "\nDynamic Range Query successful !!!";
+}
+
+// SlidingWindowRangeQuery against StaticRangeQuery over the last w values after every push.
+void sliding_test()
+{
+	for(const int w: {1, 2, 7, 64, 1000})
+	{
+		vector<int> v;
+		Generate(v);
+		for(auto& x: v)
+			x %= 50;	// plenty of ties
+
+		StaticRangeQuery srq(v);
+		SlidingWindowRangeQuery<int> swrq(w);
+		for(int i=0;i<int(v.size());++i)
+		{
+			swrq.Push(v[i]);
+			[[maybe_unused]] const int b = max(0, i - w + 1);
+			assert(swrq.Full() == (i + 1 >= w));
+			assert(swrq.Min() == srq.Min(b, i) && swrq.Max() == srq.Max(b, i));
+			assert(swrq.MinMax() == make_pair(srq.Min(b, i), srq.Max(b, i)));
+		}
+	}
+
+	cout << "\nSliding Window Range Query successful !!!";
+}
+
 int main()
 {
 	test();
-	cin.get();
-	
+	dynamic_test();
+	sliding_test();
+
+	// Timing of the layouts, the update strategies and the sliding window is in bench_minmax_range_query.cpp.
+	cout << endl;
+
 	return 0;
 }
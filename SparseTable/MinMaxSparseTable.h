@@ -0,0 +1,113 @@
+#ifndef MinMaxSparseTable_H
+#define MinMaxSparseTable_H
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <utility>
+#include <assert.h>
+#include <bit>
+#include <cstdint>
+#include <climits>
+
+// Min and max range queries over a structure-of-arrays sparse table: the min and max rows live in
+// two separate arrays sharing one row layout. A Min (or Max) query only touches its own column, the
+// build loops are plain contiguous min/max loops that the compiler vectorizes, and MinMax computes
+// the table indices once for both answers.
+template<class T = int>
+class MinMaxSparseTable
+{
+	const int n;
+	std::vector<T> mn;
+	std::vector<T> mx;
+	std::vector<int64_t> offset;	// offset[p] = index of the first element of the row with power p
+
+	public:
+
+		MinMaxSparseTable(const std::vector<T>& iv): MinMaxSparseTable(std::span<const T>(iv)) {}
+		MinMaxSparseTable(std::span<const T> iv);
+
+		int size() const
+		{
+			return n;
+		}
+
+		T Min(const int beg, const int end) const
+		{
+			auto pr = GetIndices(beg, end);
+			return std::min(mn[pr.first], mn[pr.second]);
+		}
+
+		T Max(const int beg, const int end) const
+		{
+			auto pr = GetIndices(beg, end);
+			return std::max(mx[pr.first], mx[pr.second]);
+		}
+
+		// Returns {min, max} of [beg, end]
+		std::pair<T, T> MinMax(const int beg, const int end) const
+		{
+			auto pr = GetIndices(beg, end);
+			return {std::min(mn[pr.first], mn[pr.second]), std::max(mx[pr.first], mx[pr.second])};
+		}
+
+	private:
+
+		std::pair<int64_t, int64_t> GetIndices(const int beg, const int end) const;
+};
+
+template<class T>
+MinMaxSparseTable(const std::vector<T>&) -> MinMaxSparseTable<T>;
+
+template<class T>
+MinMaxSparseTable<T>::MinMaxSparseTable(std::span<const T> iv): n(iv.size())
+{
+	// As in SparseTable, the input is indexed with int and the n * log2(n) cells with 64 bits.
+	assert(iv.size() <= size_t(INT_MAX));
+
+	const int p = n > 0 ? std::bit_width(static_cast<unsigned>(n)) - 1 : -1;
+
+	offset.resize(p + 1);
+	int64_t sz = 0;
+	for(int i=0;i<=p;++i)
+	{
+		offset[i] = sz;
+		sz += n - (1 << i) + 1;
+	}
+
+	mn.resize(sz);
+	mx.resize(sz);
+	std::copy(iv.begin(), iv.end(), mn.begin());
+	std::copy(iv.begin(), iv.end(), mx.begin());
+
+	for(int i=1;i<=p;++i)
+	{
+		const int rsz = n - (1 << i) + 1;
+		const int pw2 = 1 << (i-1);
+
+		T* dst = mn.data() + offset[i];
+		const T* src = mn.data() + offset[i-1];
+		for(int j=0;j<rsz;++j)
+			dst[j] = std::min(src[j], src[j+pw2]);
+
+		dst = mx.data() + offset[i];
+		src = mx.data() + offset[i-1];
+		for(int j=0;j<rsz;++j)
+			dst[j] = std::max(src[j], src[j+pw2]);
+	}
+}
+
+// The two overlapping windows of length 2^p cover [beg, end] where p = floor(log2(end - beg + 1))
+template<class T>
+std::pair<int64_t, int64_t> MinMaxSparseTable<T>::GetIndices(const int beg, const int end) const
+{
+	assert(beg >= 0);
+	assert(beg <= end);
+	assert(end < n);
+
+	const int p = std::bit_width(static_cast<unsigned>(end - beg + 1)) - 1;
+	const int64_t ind = offset[p];
+	return {ind + beg, ind + end - (1 << p) + 1};
+}
+
+#endif
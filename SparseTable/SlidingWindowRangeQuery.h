@@ -0,0 +1,132 @@
+#ifndef SlidingWindowRangeQuery_H
+#define SlidingWindowRangeQuery_H
+
+#include <vector>
+#include <utility>
+#include <bit>
+#include <assert.h>
+
+// Min and max of the last `window` values of a stream. After Push has been called for values
+// x[0..i], Min() and Max() are StaticRangeQuery::Min/Max(i - window + 1, i) over those values
+// (over [0, i] while fewer than `window` have arrived).
+//
+// Each of the min and max sides is a monotonic deque of (index, value): a new value first removes
+// the entries it dominates from the back, so values are increasing (min) or decreasing (max) from
+// the front, and the front is dropped once it falls out of the window. Every value enters and
+// leaves each deque at most once, so Push is amortized O(1). A deque never holds more than
+// `window` entries, so both live in fixed ring buffers and memory stays O(window) however long
+// the stream is.
+template<class T = int>
+class SlidingWindowRangeQuery
+{
+	struct Entry
+	{
+		long long index;
+		T value;
+	};
+
+	// Fixed capacity deque over a ring buffer. The buffer size is a power of two so that head and
+	// tail, which only move forward, are reduced to positions with a mask.
+	struct Ring
+	{
+		std::vector<Entry> buf;
+		size_t mask;
+		size_t head = 0;
+		size_t tail = 0;
+
+		Ring(const size_t capacity): buf(std::bit_ceil(capacity)), mask(buf.size() - 1) {}
+
+		bool empty() const
+		{
+			return head == tail;
+		}
+
+		Entry& front()
+		{
+			return buf[head & mask];
+		}
+
+		const Entry& front() const
+		{
+			return buf[head & mask];
+		}
+
+		Entry& back()
+		{
+			return buf[(tail - 1) & mask];
+		}
+
+		void push_back(const Entry& e)
+		{
+			assert(tail - head < buf.size());
+			buf[tail++ & mask] = e;
+		}
+	};
+
+	const int window;
+	long long count = 0;
+	Ring mins;
+	Ring maxs;
+
+	public:
+
+		SlidingWindowRangeQuery(const int iwindow): window(iwindow), mins(iwindow), maxs(iwindow)
+		{
+			assert(window > 0);
+		}
+
+		// Number of values pushed so far
+		long long Count() const
+		{
+			return count;
+		}
+
+		// True once the window holds `window` values
+		bool Full() const
+		{
+			return count >= window;
+		}
+
+		void Push(const T& value);
+
+		T Min() const
+		{
+			assert(count > 0);
+			return mins.front().value;
+		}
+
+		T Max() const
+		{
+			assert(count > 0);
+			return maxs.front().value;
+		}
+
+		// Returns {min, max} of the window
+		std::pair<T, T> MinMax() const
+		{
+			return {Min(), Max()};
+		}
+};
+
+template<class T>
+void SlidingWindowRangeQuery<T>::Push(const T& value)
+{
+	const long long index = count++;
+	const long long expired = index - window;
+
+	// The window moves by one, so at most the front entry expires. Dropping it first leaves room
+	// for the new entry in a ring of `window` entries.
+	if(!mins.empty() && mins.front().index <= expired)
+		++mins.head;
+	while(!mins.empty() && !(mins.back().value < value))
+		--mins.tail;
+	mins.push_back({index, value});
+
+	if(!maxs.empty() && maxs.front().index <= expired)
+		++maxs.head;
+	while(!maxs.empty() && !(value < maxs.back().value))
+		--maxs.tail;
+	maxs.push_back({index, value});
+}
+
+#endif
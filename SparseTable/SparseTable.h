@@ -2,23 +2,369 @@
 #define SparseTable_H
 
 #include <vector>
+#include <span>
+#include <algorithm>
+#include <numeric>
+#include <concepts>
+#include <assert.h>
+#include <bit>
+#include <barrier>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <climits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include "../Platform.h"
+
+// Idempotent associative operations usable with SparseTable. Op(a, a) == a is what allows a query
+// to combine two overlapping windows. The name is only needed to save a table, see MappedSparseTable.
+struct MinOp
+{
+	static constexpr char name[] = "min";
+
+	template<class T>
+	T operator()(const T& a, const T& b) const
+	{
+		return std::min(a, b);
+	}
+};
+
+struct MaxOp
+{
+	static constexpr char name[] = "max";
+
+	template<class T>
+	T operator()(const T& a, const T& b) const
+	{
+		return std::max(a, b);
+	}
+};
+
+struct GcdOp
+{
+	static constexpr char name[] = "gcd";
+
+	template<class T>
+	T operator()(const T& a, const T& b) const
+	{
+		return std::gcd(a, b);
+	}
+};
+
+struct BitAndOp
+{
+	static constexpr char name[] = "and";
+
+	template<class T>
+	T operator()(const T& a, const T& b) const
+	{
+		return a & b;
+	}
+};
+
+struct BitOrOp
+{
+	static constexpr char name[] = "or";
 
+	template<class T>
+	T operator()(const T& a, const T& b) const
+	{
+		return a | b;
+	}
+};
+
+template<class T, class Op>
+class MappedSparseTable;
+
+// Static range query over the values of T combined with Op, e.g. SparseTable<double, MaxOp>.
+// Argmin is SparseTable<std::pair<T, int>> over (value, index) pairs; ties resolve to the smallest index.
+// Op is a type rather than a function pointer so that the build loop is inlined and vectorized.
+template<class T = int, class Op = MinOp>
 class SparseTable
 {
 	const int n;
-	std::vector<int> v;
+	std::vector<T> v;
+	std::vector<int64_t> offset;	// offset[p] = index in v of the first element of the row with power p
+	[[no_unique_address]] Op op;
+
+	friend class MappedSparseTable<T, Op>;
 
 	public:
 
-		SparseTable(std::vector<int>& iv);
-		int Min(const int beg, const int end);
+		// threads > 1 builds the levels in parallel; each level is split into slices, one per thread,
+		// and the threads meet at a barrier before starting the next level.
+		// The input holds at most INT_MAX elements since queries index it with int; the table itself
+		// (about n * log2(n) cells, 2.6e9 for n = 1e8) is indexed with 64 bits.
+		SparseTable(const std::vector<T>& iv, const int threads = 1): SparseTable(std::span<const T>(iv), threads) {}
+		SparseTable(std::span<const T> iv, const int threads = 1);
+
+		// Defined in the class so that the O(1) query is inlined into the caller's loop.
+		T Query(const int beg, const int end) const
+		{
+			auto pr = GetIndices(beg, end);
+			return op(v[pr.first], v[pr.second]);
+		}
+
+		// The range minimum query of the default MinOp table
+		T Min(const int beg, const int end) const requires std::same_as<Op, MinOp>
+		{
+			return Query(beg, end);
+		}
+
+		// Answers queries[i] = {beg, end} into out[i]. The table indices of a block of queries are computed
+		// first and their cells prefetched so that the cache misses of the block overlap. Min and max
+		// tables of int compute the indices and gather the cells 8 queries at a time with AVX2.
+		void QueryBatch(std::span<const std::pair<int, int>> queries, std::span<T> out) const;
+
+		void MinBatch(std::span<const std::pair<int, int>> queries, std::span<T> out) const requires std::same_as<Op, MinOp>
+		{
+			QueryBatch(queries, out);
+		}
+
+		// Bytes held by the table, about n * log2(n) * sizeof(T)
+		size_t MemoryBytes() const
+		{
+			return v.capacity() * sizeof(T) + offset.capacity() * sizeof(int64_t);
+		}
 
 	private:
 
-		std::pair<int, int> GetIndices(const int beg, const int end);
-		int Log2(int sz);
-		int GetCumSize(int p);
+		static constexpr int batch_block = 64;
+
+		void BuildSlice(std::span<const T> iv, const int part, const int parts, std::barrier<>* sync);
+
+		void QueryBatchScalar(std::span<const std::pair<int, int>> queries, std::span<T> out) const;
+#if defined(__x86_64__) || defined(__i386__)
+		[[gnu::target("avx2")]] void QueryBatchAVX2(std::span<const std::pair<int, int>> queries, std::span<T> out) const;
+#endif
+
+		// Returns the indices of elements in sparse table given the indices of elements in static array
+		// The two overlapping windows of length 2^p cover [beg, end] where p = floor(log2(end - beg + 1))
+		std::pair<int64_t, int64_t> GetIndices(const int beg, const int end) const
+		{
+			assert(beg >= 0);
+			assert(beg < n);
+			assert(end >= beg);
+			assert(end < n);
+
+			int p = Log2(end - beg + 1);
+			int64_t ind = offset[p];
+			int64_t b = ind + beg;
+			int64_t e = ind + end - (1 << p) + 1;
+
+			assert(b >= 0);
+			assert(b < int64_t(v.size()));
+			assert(e >= b);
+			assert(e < int64_t(v.size()));
+
+			return {b, e};
+		}
+
+		// Returns the highest possible power over 2 such that 2 ^ p <= sz
+		int Log2(int sz) const
+		{
+			assert(sz > 0);
+			return std::bit_width(static_cast<unsigned>(sz)) - 1;
+		}
+
+		int64_t GetCumSize(int p) const;
 };
 
+template<class T>
+SparseTable(const std::vector<T>&) -> SparseTable<T>;
+
+template<class T>
+SparseTable(const std::vector<T>&, int) -> SparseTable<T>;
+
+template<class T, class Op>
+SparseTable<T, Op>::SparseTable(std::span<const T> iv, const int threads): n(iv.size())
+{
+	assert(iv.size() <= size_t(INT_MAX));
+
+	int p = n > 0 ? Log2(n) : -1;
+	int64_t sz = GetCumSize(p);
+
+	offset.resize(p + 1);
+	for(int i=0;i<=p;++i)
+		offset[i] = GetCumSize(i-1);
+
+	v.resize(sz);
+
+	const int parts = std::clamp(n / min_parallel_slice, 1, std::max(threads, 1));
+	if(parts == 1)
+	{
+		BuildSlice(iv, 0, 1, nullptr);
+		return;
+	}
+
+	std::barrier<> sync(parts);
+	std::vector<std::thread> workers;
+	for(int t = 1; t < parts; ++t)
+		workers.emplace_back([&, t] { BuildSlice(iv, t, parts, &sync); });
+
+	BuildSlice(iv, 0, parts, &sync);
+	for(auto& w: workers)
+		w.join();
+}
+
+// Copies slice part of the input and then computes slice part of every level. Level i reads level
+// i-1 up to 2^(i-1) elements past its own slice, so all the slices of a level must be complete
+// before any slice of the next one starts.
+template<class T, class Op>
+void SparseTable<T, Op>::BuildSlice(std::span<const T> iv, const int part, const int parts, std::barrier<>* sync)
+{
+	auto slice = [&](const int sz) -> std::pair<int, int> {
+		return {int((long long)sz * part / parts), int((long long)sz * (part + 1) / parts)};
+	};
+
+	auto [first, last] = slice(n);
+	std::copy(iv.begin() + first, iv.begin() + last, v.begin() + first);
+
+	int p = n > 0 ? Log2(n) : -1;
+	int64_t beg = 0, end = n;
+	int sz, pw2;
+	for(int i=1;i<=p;++i)
+	{
+		if(sync != nullptr)
+			sync->arrive_and_wait();
+
+		sz = n - (1 << i) + 1;
+		pw2 = 1 << (i-1);
+		T* dst = v.data() + end;
+		const T* src = v.data() + beg;
+		auto [from, to] = slice(sz);
+		for(int j=from;j<to;++j)
+			dst[j] = op(src[j], src[j+pw2]);
+
+		beg = end;
+		end += sz;
+	}
+}
+
+template<class T, class Op>
+void SparseTable<T, Op>::QueryBatch(std::span<const std::pair<int, int>> queries, std::span<T> out) const
+{
+	assert(out.size() >= queries.size());
+
+#if defined(__x86_64__) || defined(__i386__)
+	if constexpr(std::is_same_v<T, int> && (std::is_same_v<Op, MinOp> || std::is_same_v<Op, MaxOp>))
+	{
+		if(has_avx2())
+		{
+			QueryBatchAVX2(queries, out);
+			return;
+		}
+	}
 #endif
 
+	QueryBatchScalar(queries, out);
+}
+
+template<class T, class Op>
+void SparseTable<T, Op>::QueryBatchScalar(std::span<const std::pair<int, int>> queries, std::span<T> out) const
+{
+	int64_t b[batch_block], e[batch_block];
+	for(size_t q0 = 0; q0 < queries.size(); q0 += batch_block)
+	{
+		const int cnt = std::min<size_t>(batch_block, queries.size() - q0);
+		for(int k = 0; k < cnt; ++k)
+		{
+			auto pr = GetIndices(queries[q0+k].first, queries[q0+k].second);
+			b[k] = pr.first;
+			e[k] = pr.second;
+			__builtin_prefetch(&v[b[k]]);
+			__builtin_prefetch(&v[e[k]]);
+		}
+
+		for(int k = 0; k < cnt; ++k)
+			out[q0+k] = op(v[b[k]], v[e[k]]);
+	}
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template<class T, class Op>
+void SparseTable<T, Op>::QueryBatchAVX2(std::span<const std::pair<int, int>> queries, std::span<T> out) const
+{
+	if constexpr(std::is_same_v<T, int>)
+	{
+		alignas(32) int b[batch_block], e[batch_block];
+		alignas(32) int64_t ib[batch_block], ie[batch_block];
+		alignas(32) int res[batch_block];
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256i bias = _mm256_set1_epi32(127);
+
+		for(size_t q0 = 0; q0 < queries.size(); q0 += batch_block)
+		{
+			const int cnt = std::min<size_t>(batch_block, queries.size() - q0);
+			for(int k = 0; k < cnt; ++k)
+			{
+				b[k] = queries[q0+k].first;
+				e[k] = queries[q0+k].second;
+				assert(0 <= b[k] && b[k] <= e[k] && e[k] < n);
+			}
+			// Pad the last vector with the valid query [0, 0].
+			const int padded = (cnt + 7) & ~7;
+			for(int k = cnt; k < padded; ++k)
+				b[k] = e[k] = 0;
+
+			for(int k = 0; k < padded; k += 8)
+			{
+				const __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + k));
+				const __m256i ve = _mm256_load_si256(reinterpret_cast<const __m256i*>(e + k));
+				const __m256i len = _mm256_add_epi32(_mm256_sub_epi32(ve, vb), one);
+
+				// floor(log2(len)) from the float exponent; the conversion may round len up to the next
+				// power of two, which the comparison corrects.
+				__m256i p = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(len)), 23), bias);
+				p = _mm256_add_epi32(p, _mm256_cmpgt_epi32(_mm256_sllv_epi32(one, p), len));
+
+				// The positions within a row fit in 32 bits, the row offsets need 64: each half of the
+				// vector is widened to 4 lanes of 64 bits before the offset is added.
+				const __m256i vb2 = _mm256_sub_epi32(_mm256_add_epi32(ve, one), _mm256_sllv_epi32(one, p));
+				for(int h = 0; h < 2; ++h)
+				{
+					const __m128i ph = h ? _mm256_extracti128_si256(p, 1) : _mm256_castsi256_si128(p);
+					const __m128i bh = h ? _mm256_extracti128_si256(vb, 1) : _mm256_castsi256_si128(vb);
+					const __m128i eh = h ? _mm256_extracti128_si256(vb2, 1) : _mm256_castsi256_si128(vb2);
+					const __m256i ind = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(offset.data()), ph, 8);
+					_mm256_store_si256(reinterpret_cast<__m256i*>(ib + k + 4*h), _mm256_add_epi64(ind, _mm256_cvtepi32_epi64(bh)));
+					_mm256_store_si256(reinterpret_cast<__m256i*>(ie + k + 4*h), _mm256_add_epi64(ind, _mm256_cvtepi32_epi64(eh)));
+				}
+			}
+
+			for(int k = 0; k < cnt; ++k)
+			{
+				__builtin_prefetch(&v[ib[k]]);
+				__builtin_prefetch(&v[ie[k]]);
+			}
+
+			for(int k = 0; k < padded; k += 4)
+			{
+				const __m128i c1 = _mm256_i64gather_epi32(v.data(), _mm256_load_si256(reinterpret_cast<const __m256i*>(ib + k)), 4);
+				const __m128i c2 = _mm256_i64gather_epi32(v.data(), _mm256_load_si256(reinterpret_cast<const __m256i*>(ie + k)), 4);
+				const __m128i r = std::is_same_v<Op, MinOp> ? _mm_min_epi32(c1, c2) : _mm_max_epi32(c1, c2);
+				_mm_store_si128(reinterpret_cast<__m128i*>(res + k), r);
+			}
+
+			std::copy(res, res + cnt, out.begin() + q0);
+		}
+	}
+}
+#endif
+
+// Returns the total number of elements in (conceptual) rows of sparse table from 0 to p
+// The number of elements in a row with power p = n - 2^p + 1
+template<class T, class Op>
+int64_t SparseTable<T, Op>::GetCumSize(int p) const
+{
+	int64_t csz = 0;
+	for(int I = 0; I <= p; ++I)
+		csz += (n - (int64_t(1) << I) + 1);
+
+	return csz;
+}
+
+#endif
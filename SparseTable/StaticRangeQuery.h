@@ -0,0 +1,122 @@
+#ifndef StaticRangeQuery_H
+#define StaticRangeQuery_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+// Min and max range queries from one sparse table of (min, max) pairs.
+// MinMaxSparseTable keeps the two columns in separate arrays.
+class StaticRangeQuery
+{
+	const int n;
+	std::vector<std::pair<int, int>> v;
+	
+	public:
+	StaticRangeQuery(std::vector<int>& iv) : n(iv.size())
+	{
+		int p = Log2(n);
+		int sz = GetCumSize(p);
+		
+		v.resize(sz);
+		for(int i=0;i<n;++i)
+			v[i] = {iv[i], iv[i]};
+		
+		int beg=0, end=n;
+		std::pair<int, int> val1, val2;
+		for(int i=1;i<=p;++i)
+		{
+			sz = n - (1 << i) + 1;
+			for(int j=0;j<sz;++j)
+			{
+				val1 = v[beg+j];
+				val2 = v[beg+j+(1<<(i-1))];
+				v[end+j] = {std::min(val1.first, val2.first), std::max(val1.second, val2.second)};
+			}
+			
+			beg = end;
+			end += sz;
+		}
+	}
+	
+	int size()
+	{
+		return n;
+	}
+	
+	int Log2(const int num)
+	{
+		int p=-1;
+		while( (1<<(p+1)) <= num)
+			++p;
+		return p;
+	}
+	
+	int GetCumSize(const int p)
+	{
+		int sz = 0;
+		for(int i=0;i<=p;++i)
+			sz += (n-(1<<i)+1);
+		return sz;
+	}
+	
+	std::pair<int, int> GetIndices(const int beg, const int end)
+	{
+		assert(0 <= beg);
+		assert(beg < n);
+		assert(beg <= end);
+		assert(0 <= end);
+		assert(end < n);
+
+		if(beg == end)
+			return {beg, end};
+
+		int sz = end - beg + 1;
+		int p = Log2(sz);
+		int ind = GetCumSize(p-1);
+		int b = ind+beg;
+		int e = ind+end-(1<<p)+1;
+		return {b, e};
+	}
+	
+	int Min(const int beg, const int end)
+	{
+		auto pr = GetIndices(beg, end);
+		int ans = v[pr.first].first;
+		if(pr.first != pr.second)
+			ans = std::min(ans, v[pr.second].first);
+		
+		return ans;
+	}
+	
+	int Max(const int beg, const int end)
+	{
+		auto pr = GetIndices(beg, end);
+		int ans = v[pr.first].second;
+		if(pr.first != pr.second)
+			ans = std::max(ans, v[pr.second].second);
+		
+		return ans;
+	}
+	
+	void print()
+	{
+		std::cout << "\n [ ";
+		for(int i=0;i<n;++i)
+			std::cout << v[i].first << " ";
+		std::cout << "]\n";
+		
+		std::cout << "\nMin: " << v.size() << " [ ";
+		for(const auto& i: v)
+			std::cout << i.first << " ";
+		std::cout << "]\n";
+		
+		std::cout << "\nMax: " << v.size() << " [ ";
+		for(const auto& i: v)
+			std::cout << i.second<< " ";
+		std::cout << "]\n";
+	}
+};
+
+#endif
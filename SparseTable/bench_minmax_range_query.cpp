@@ -0,0 +1,261 @@
+// Min/max range query benchmarks: the pair layout of StaticRangeQuery against the structure-of-arrays
+// MinMaxSparseTable, DynamicRangeQuery against rebuilding a table after each change, and
+// SlidingWindowRangeQuery against a table over the materialized stream. The correctness tests are
+// in MinMaxSparseTable.cpp.
+//
+//	g++ -std=c++20 -O2 -DNDEBUG bench_minmax_range_query.cpp -o bench_minmax_range_query
+//	./bench_minmax_range_query	(the 1e7 element tables take about 2 GB)
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <random>
+#include <optional>
+#include "StaticRangeQuery.h"
+#include "MinMaxSparseTable.h"
+#include "DynamicRangeQuery.h"
+#include "SlidingWindowRangeQuery.h"
+
+using namespace std;
+
+// The pair layout of StaticRangeQuery with the O(1) index computation of MinMaxSparseTable, so that
+// the benchmark separates the effect of the layout from that of the index computation.
+class PairSparseTable
+{
+	const int n;
+	vector<pair<int, int>> v;
+	vector<int64_t> offset;
+
+	public:
+	PairSparseTable(const vector<int>& iv) : n(iv.size())
+	{
+		const int p = bit_width(unsigned(n)) - 1;
+		offset.resize(p + 1);
+		int64_t sz = 0;
+		for(int i=0;i<=p;++i)
+		{
+			offset[i] = sz;
+			sz += n - (1 << i) + 1;
+		}
+
+		v.resize(sz);
+		for(int i=0;i<n;++i)
+			v[i] = {iv[i], iv[i]};
+
+		for(int i=1;i<=p;++i)
+		{
+			const pair<int, int>* src = v.data() + offset[i-1];
+			pair<int, int>* dst = v.data() + offset[i];
+			for(int j=0;j<n-(1<<i)+1;++j)
+				dst[j] = {min(src[j].first, src[j+(1<<(i-1))].first), max(src[j].second, src[j+(1<<(i-1))].second)};
+		}
+	}
+
+	pair<int, int> MinMax(const int beg, const int end) const
+	{
+		const int p = bit_width(unsigned(end - beg + 1)) - 1;
+		const auto& a = v[offset[p] + beg];
+		const auto& b = v[offset[p] + end - (1 << p) + 1];
+		return {min(a.first, b.first), max(a.second, b.second)};
+	}
+};
+
+// Window min/max over a stream of n values: streaming with SlidingWindowRangeQuery against
+// materializing the stream, building MinMaxSparseTable and querying every window.
+void sliding_benchmark(const int n, const int w)
+{
+	mt19937 gen(11);
+	auto start = chrono::steady_clock::now();
+	SlidingWindowRangeQuery<int> swrq(w);
+	long long stream_checksum = 0;
+	for(int i=0;i<n;++i)
+	{
+		swrq.Push(gen() % 100000);
+		if(swrq.Full())
+		{
+			auto mm = swrq.MinMax();
+			stream_checksum += (long long)mm.first + mm.second;
+		}
+	}
+	auto end = chrono::steady_clock::now();
+	double stream_ns = chrono::duration<double, nano>(end-start).count() / n;
+
+	gen.seed(11);
+	start = chrono::steady_clock::now();
+	vector<int> v(n);
+	for(auto& x: v)
+		x = gen() % 100000;
+	MinMaxSparseTable<int> mmst(v);
+	long long table_checksum = 0;
+	for(int i=w-1;i<n;++i)
+	{
+		auto mm = mmst.MinMax(i - w + 1, i);
+		table_checksum += (long long)mm.first + mm.second;
+	}
+	end = chrono::steady_clock::now();
+	double table_ns = chrono::duration<double, nano>(end-start).count() / n;
+	assert(stream_checksum == table_checksum);
+
+	cout << "\nn = " << n << ", window " << w << ": SlidingWindowRangeQuery " << stream_ns << " ns/value, "
+		<< "materialized MinMaxSparseTable " << table_ns << " ns/value (checksum " << stream_checksum << ")";
+}
+
+// Times fn over the same random queries for every structure and prints ns/query.
+template<class Fn>
+void time_queries(const vector<pair<int, int>>& queries, Fn fn, const string& msg)
+{
+	auto start = chrono::steady_clock::now();
+
+	long long checksum = 0;
+	for(const auto& q: queries)
+		checksum += fn(q.first, q.second);
+
+	auto end = chrono::steady_clock::now();
+	double ns = chrono::duration<double, nano>(end-start).count() / queries.size();
+
+	cout << "\n" << msg << ns << " ns/query (checksum " << checksum << ")";
+}
+
+// Pair layout (StaticRangeQuery) against the structure-of-arrays layout (MinMaxSparseTable) over n elements.
+void benchmark(const int n)
+{
+	vector<int> v(n);
+	for(int i=0;i<n;++i)
+		v[i] = rand() % 100000;
+
+	vector<pair<int, int>> queries(5000000);
+	for(auto& q: queries)
+	{
+		int b = rand() % n;
+		int e = rand() % n;
+		if(b > e)
+			swap(b, e);
+		q = {b, e};
+	}
+
+	cout << "\n\nn = " << n;
+
+	// One structure at a time: at 1e7 elements each table takes about 2 GB.
+	auto build = [&](auto tag, const string& name) {
+		auto start = chrono::steady_clock::now();
+		typename decltype(tag)::type rq(v);
+		auto end = chrono::steady_clock::now();
+		cout << "\n" << name << " build: " << chrono::duration<double, milli>(end-start).count() << " ms";
+		return rq;
+	};
+
+	{
+		StaticRangeQuery srq = build(type_identity<StaticRangeQuery>(), "Pair");
+		time_queries(queries, [&](int b, int e) { return srq.Min(b, e); }, "Pair Min:    ");
+		time_queries(queries, [&](int b, int e) { return (long long)srq.Min(b, e) + srq.Max(b, e); }, "Pair Min+Max: ");
+	}
+	{
+		PairSparseTable pst = build(type_identity<PairSparseTable>(), "Pair (O(1) indices)");
+		time_queries(queries, [&](int b, int e) { return pst.MinMax(b, e).first; }, "Pair Min (O(1) indices): ");
+		time_queries(queries, [&](int b, int e) { auto mm = pst.MinMax(b, e); return (long long)mm.first + mm.second; }, "Pair MinMax (O(1) indices): ");
+	}
+	{
+		MinMaxSparseTable<int> mmst = build(type_identity<MinMaxSparseTable<int>>(), "SoA");
+		time_queries(queries, [&](int b, int e) { return mmst.Min(b, e); }, "SoA  Min:    ");
+		time_queries(queries, [&](int b, int e) { auto mm = mmst.MinMax(b, e); return (long long)mm.first + mm.second; }, "SoA  MinMax:  ");
+	}
+}
+
+// Mixed workload over n elements where a fraction of the operations change the data (half point
+// updates, half appends) and the rest are MinMax queries. DynamicRangeQuery applies each change in
+// O(log n); the alternative rebuilds a MinMaxSparseTable before the first query after a change.
+// The rebuild side runs fewer operations (about 100 changes) and both report ns/operation.
+void update_benchmark(const int n, const double change_ratio)
+{
+	vector<int> v(n);
+	for(auto& x: v)
+		x = rand() % 100000;
+
+	auto run = [&](auto& apply, const int num_ops) {
+		vector<int> cur = v;
+		mt19937 gen(7);
+		uniform_real_distribution<double> coin(0, 1);
+		long long checksum = 0;
+
+		auto start = chrono::steady_clock::now();
+		for(int op=0;op<num_ops;++op)
+		{
+			if(coin(gen) < change_ratio)
+			{
+				if(gen() & 1)
+					apply.Update(cur, gen() % cur.size(), gen() % 100000);
+				else
+					apply.PushBack(cur, gen() % 100000);
+			}
+			else
+			{
+				int b = gen() % cur.size();
+				int e = gen() % cur.size();
+				if(b > e)
+					swap(b, e);
+				checksum += apply.MinMax(cur, b, e);
+			}
+		}
+		auto end = chrono::steady_clock::now();
+
+		return make_pair(chrono::duration<double, nano>(end-start).count() / num_ops, checksum);
+	};
+
+	struct Tree
+	{
+		DynamicRangeQuery<int> drq;
+		void Update(vector<int>&, int i, int x) { drq.Update(i, x); }
+		void PushBack(vector<int>& cur, int x) { cur.push_back(x); drq.PushBack(x); }
+		long long MinMax(vector<int>&, int b, int e) { auto mm = drq.MinMax(b, e); return (long long)mm.first + mm.second; }
+	};
+
+	struct Rebuild
+	{
+		optional<MinMaxSparseTable<int>> mmst;
+		void Update(vector<int>& cur, int i, int x) { cur[i] = x; mmst.reset(); }
+		void PushBack(vector<int>& cur, int x) { cur.push_back(x); mmst.reset(); }
+		long long MinMax(vector<int>& cur, int b, int e)
+		{
+			if(!mmst)
+				mmst.emplace(cur);
+			auto mm = mmst->MinMax(b, e);
+			return (long long)mm.first + mm.second;
+		}
+	};
+
+	const int tree_ops = 2000000;
+	const int rebuild_ops = min<double>(tree_ops, 100 / change_ratio);
+
+	Tree tree{DynamicRangeQuery<int>(v)}, check_tree{DynamicRangeQuery<int>(v)};
+	Rebuild rebuild{MinMaxSparseTable<int>(v)};
+	auto t = run(tree, tree_ops);
+	auto r = run(rebuild, rebuild_ops);
+	[[maybe_unused]] const long long check_checksum = run(check_tree, rebuild_ops).second;
+	assert(check_checksum == r.second);
+
+	cout << "\nn = " << n << ", " << change_ratio * 100 << "% changes: DynamicRangeQuery " << t.first
+		<< " ns/op, rebuild on change " << r.first << " ns/op (checksum " << r.second << ")";
+}
+
+int main()
+{
+	benchmark(1000000);
+	benchmark(10000000);
+
+	cout << "\n";
+	for(const double ratio: {0.0001, 0.001, 0.01, 0.1, 0.5})
+		update_benchmark(1000000, ratio);
+
+	cout << "\n";
+	for(const int w: {16, 1000, 100000})
+		sliding_benchmark(10000000, w);
+	cout << endl;
+
+	return 0;
+}
@@ -0,0 +1,312 @@
+// Range minimum query benchmark: naive scan, SparseTable, BlockRMQ and StaticRangeQuery over input
+// sizes whose tables range from L1 to DRAM.
+//
+// Every structure answers the same random queries. They are timed in batches of 128 so that the
+// clock overhead stays small against ~10 ns queries; the percentiles are those of the per-batch
+// ns/query. The answers are summed into a checksum that is printed, so no query can be optimized
+// away. When the kernel allows perf_event_open the L1D and last level cache misses per query are
+// reported too (otherwise "n/a", e.g. with kernel.perf_event_paranoid > 2 or inside containers).
+//
+// At the largest size it then times SparseTable::MinBatch against single queries, the build with
+// 1 to N threads, and saving and mapping a MappedSparseTable (in the system temp directory).
+//
+//	g++ -std=c++20 -O2 -DNDEBUG bench_range_query.cpp -pthread -o bench_range_query
+//	./bench_range_query [max_log2_size]	(default 23, i.e. up to 8M elements)
+#include "SparseTable.h"
+#include "BlockRMQ.h"
+#include "StaticRangeQuery.h"
+#include "MappedSparseTable.h"
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+#include <optional>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// One hardware counter of the calling thread, user space only. Valid() is false when the kernel
+// refuses to open it, and then Stop() returns -1.
+class PerfCounter
+{
+	int fd = -1;
+
+	public:
+
+		PerfCounter(const uint32_t type, const uint64_t config)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = type;
+			attr.config = config;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		}
+
+		PerfCounter(const PerfCounter&) = delete;
+		PerfCounter& operator=(const PerfCounter&) = delete;
+
+		~PerfCounter()
+		{
+			if(fd >= 0)
+				close(fd);
+		}
+
+		bool Valid() const
+		{
+			return fd >= 0;
+		}
+
+		void Start()
+		{
+			if(fd >= 0)
+			{
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+
+		long long Stop()
+		{
+			if(fd < 0)
+				return -1;
+
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			long long count = 0;
+			if(read(fd, &count, sizeof(count)) != sizeof(count))
+				return -1;
+			return count;
+		}
+};
+
+struct Result
+{
+	double mean_ns;
+	double p50_ns;
+	double p90_ns;
+	double p99_ns;
+	double l1_misses;	// per query, negative when not available
+	double llc_misses;
+	long long checksum;
+};
+
+// Runs fn over every query, timing batches of batch_size queries.
+template<class Fn>
+Result Measure(const std::vector<std::pair<int, int>>& queries, Fn fn)
+{
+	const int batch_size = 128;
+	static PerfCounter l1(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+	static PerfCounter llc(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+	std::vector<double> batch_ns;
+	batch_ns.reserve(queries.size() / batch_size + 1);
+	long long checksum = 0;
+
+	l1.Start();
+	llc.Start();
+	auto start = std::chrono::steady_clock::now();
+	for(size_t I = 0; I < queries.size(); I += batch_size)
+	{
+		const size_t end = std::min(queries.size(), I + batch_size);
+		auto batch_start = std::chrono::steady_clock::now();
+		for(size_t J = I; J < end; ++J)
+			checksum += fn(queries[J].first, queries[J].second);
+		auto batch_end = std::chrono::steady_clock::now();
+		batch_ns.push_back(std::chrono::duration<double, std::nano>(batch_end - batch_start).count() / (end - I));
+	}
+	auto end = std::chrono::steady_clock::now();
+	const long long l1_misses = l1.Stop();
+	const long long llc_misses = llc.Stop();
+
+	std::sort(batch_ns.begin(), batch_ns.end());
+	auto percentile = [&](const double p) {
+		return batch_ns[std::min(batch_ns.size() - 1, size_t(p * batch_ns.size()))];
+	};
+
+	const double nq = queries.size();
+	return {std::chrono::duration<double, std::nano>(end - start).count() / nq, percentile(0.5), percentile(0.9), percentile(0.99),
+		l1_misses < 0 ? -1 : l1_misses / nq, llc_misses < 0 ? -1 : llc_misses / nq, checksum};
+}
+
+void Print(const std::string& name, const size_t bytes, const size_t num_queries, const Result& r)
+{
+	auto misses = [](const double m) {
+		return m < 0 ? std::string("n/a") : std::to_string(m).substr(0, std::to_string(m).find('.') + 3);
+	};
+
+	std::cout << "  " << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(1)
+		<< std::setw(12) << bytes / 1024.0 << std::setw(9) << num_queries << std::setw(12) << r.mean_ns
+		<< std::setw(12) << r.p50_ns << std::setw(12) << r.p90_ns << std::setw(12) << r.p99_ns
+		<< std::setw(10) << misses(r.l1_misses) << std::setw(10) << misses(r.llc_misses) << "   " << r.checksum << "\n";
+}
+
+std::vector<std::pair<int, int>> RandomQueries(const int n, const int num_queries, std::mt19937& gen)
+{
+	std::vector<std::pair<int, int>> queries(num_queries);
+	for(auto& q: queries)
+	{
+		int b = gen() % n;
+		int e = gen() % n;
+		if(b > e)
+			std::swap(b, e);
+		q = {b, e};
+	}
+	return queries;
+}
+
+void Benchmark(const int n)
+{
+	std::mt19937 gen(n);
+	std::vector<int> v(n);
+	for(auto& x: v)
+		x = gen() % 1000000;
+
+	// The naive scan is O(n) per query, so on large inputs it runs only a prefix of the queries and
+	// its checksum differs from the others.
+	const int num_queries = 1 << 20;
+	const int naive_queries = std::clamp<long long>((1ll << 28) / n, 1 << 10, num_queries);
+	const std::vector<std::pair<int, int>> queries = RandomQueries(n, num_queries, gen);
+
+	std::cout << "\nn = " << n << " (" << n * sizeof(int) / 1024.0 << " KB of input)\n";
+	std::cout << "  structure             table KB  queries     mean ns      p50 ns      p90 ns      p99 ns  L1D miss  LLC miss   checksum\n";
+
+	{
+		std::vector<std::pair<int, int>> naive(queries.begin(), queries.begin() + naive_queries);
+		Print("naive scan", v.size() * sizeof(int), naive.size(), Measure(naive, [&](const int b, const int e) {
+			return *std::min_element(v.begin() + b, v.begin() + e + 1);
+		}));
+	}
+	{
+		SparseTable st(v);
+		Print("SparseTable", st.MemoryBytes(), queries.size(), Measure(queries, [&](const int b, const int e) { return st.Min(b, e); }));
+	}
+	{
+		BlockRMQ brmq(v);
+		Print("BlockRMQ", brmq.MemoryBytes(), queries.size(), Measure(queries, [&](const int b, const int e) { return brmq.Min(b, e); }));
+	}
+	{
+		StaticRangeQuery srq(v);
+		size_t levels = 0;
+		for(int len = 1; len <= n; len <<= 1)
+			levels += n - len + 1;
+		Print("StaticRangeQuery", levels * sizeof(std::pair<int, int>), queries.size(), Measure(queries, [&](const int b, const int e) { return srq.Min(b, e); }));
+	}
+}
+
+template<class Fn>
+double TimeMs(Fn fn)
+{
+	auto start = std::chrono::steady_clock::now();
+	fn();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// SparseTable::MinBatch in batches of 10000 against a loop of single Min calls.
+void BatchBenchmark(const std::vector<int>& v, const std::vector<std::pair<int, int>>& queries)
+{
+	SparseTable st(v);
+	long long checksum = 0;
+	const double single_ms = TimeMs([&] {
+		for(const auto& q: queries)
+			checksum += st.Min(q.first, q.second);
+	});
+
+	const size_t batch = 10000;
+	std::vector<int> out(queries.size());
+	const double batch_ms = TimeMs([&] {
+		for(size_t I = 0; I < queries.size(); I += batch)
+		{
+			const size_t cnt = std::min(batch, queries.size() - I);
+			st.MinBatch(std::span(queries).subspan(I, cnt), std::span(out).subspan(I, cnt));
+		}
+	});
+
+	long long batch_checksum = 0;
+	for(const int mn: out)
+		batch_checksum += mn;
+
+	std::cout << "\nSparseTable n = " << v.size() << ": Min " << single_ms * 1e6 / queries.size() << " ns/query, MinBatch "
+		<< batch_ms * 1e6 / queries.size() << " ns/query (checksums " << checksum << ", " << batch_checksum << ")\n";
+}
+
+// Best of three builds with 1 to N threads; the first allocation of the table pays for page faults
+// the later ones may not.
+void BuildBenchmark(const std::vector<int>& v)
+{
+	const int max_threads = std::max(2u, std::thread::hardware_concurrency());
+	double serial_ms = 0;
+	for(int threads = 1; threads <= max_threads; ++threads)
+	{
+		double ms = 1e300;
+		for(int run = 0; run < 3; ++run)
+			ms = std::min(ms, TimeMs([&] { SparseTable st(v, threads); }));
+		if(threads == 1)
+			serial_ms = ms;
+
+		std::cout << "SparseTable build n = " << v.size() << " with " << threads << " thread(s): " << ms << " ms (speedup " << serial_ms / ms << ")\n";
+	}
+}
+
+// Time to save a table and to open it, with and without checking the checksum, against the time to
+// build it; then the queries of the mapping against those of the table in memory.
+void MappedBenchmark(const std::vector<int>& v, const std::vector<std::pair<int, int>>& queries)
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "bench_range_query.spt").string();
+
+	std::optional<SparseTable<int>> st;
+	const double build_ms = TimeMs([&] { st.emplace(v); });
+	const double save_ms = TimeMs([&] { MappedSparseTable<int>::Save(*st, path); });
+	const double open_ms = TimeMs([&] { MappedSparseTable<int> mst(path); });
+	const double verify_ms = TimeMs([&] { MappedSparseTable<int> mst(path, true); });
+
+	std::cout << "\nMappedSparseTable n = " << v.size() << ": build " << build_ms << " ms, save " << save_ms << " ms, open "
+		<< open_ms * 1000 << " us, open with checksum " << verify_ms << " ms\n";
+	std::cout << "  structure             table KB  queries     mean ns      p50 ns      p90 ns      p99 ns  L1D miss  LLC miss   checksum\n";
+
+	Print("SparseTable", st->MemoryBytes(), queries.size(), Measure(queries, [&](const int b, const int e) { return st->Min(b, e); }));
+	st.reset();
+	{
+		MappedSparseTable<int> mst(path);
+		Print("MappedSparseTable", std::filesystem::file_size(path), queries.size(), Measure(queries, [&](const int b, const int e) { return mst.Min(b, e); }));
+	}
+
+	std::remove(path.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+	const int max_log2 = argc > 1 ? std::atoi(argv[1]) : 23;
+
+	// From a table that fits in L1 to one that is hundreds of MB.
+	for(int lg = 8; lg <= max_log2; lg += 3)
+		Benchmark(1 << lg);
+
+	const int n = 1 << max_log2;
+	std::mt19937 gen(n);
+	std::vector<int> v(n);
+	for(auto& x: v)
+		x = gen() % 1000000;
+	const std::vector<std::pair<int, int>> queries = RandomQueries(n, 1 << 22, gen);
+
+	BatchBenchmark(v, queries);
+	std::cout << "\n";
+	BuildBenchmark(v);
+	MappedBenchmark(v, queries);
+
+	std::cout << std::endl;
+	return 0;
+}
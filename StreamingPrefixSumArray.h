@@ -0,0 +1,117 @@
+#ifndef StreamingPrefixSumArray_H
+#define StreamingPrefixSumArray_H
+
+#include <vector>
+#include <bit>
+#include <algorithm>
+#include <assert.h>
+#include "PrefixSumArray.h"
+
+// Append-only PrefixSumArray for an unbounded stream that keeps only the most recent values.
+// Append and RangeSumQuery are O(1), and memory is fixed by the retention limit however long the
+// stream is:
+//
+//	StreamingPrefixSumArray<int> sums(4000000);	// keep at least the last 4M values
+//	sums.Append(bytes);	// for every value received
+//	int64_t recent = sums.RangeSumQuery(sums.size() - 1000, sums.size() - 1);
+//
+// Indices are positions in the whole stream. The values are kept in a ring of blocks of 4096;
+// when the stream enters a new block the oldest one is overwritten. A block stores the sums of its
+// values from its own start, and separately the sum of the stream before it, so a query never
+// needs a dropped block: the sum before index l is base(l's block) plus the local sum up to l-1
+// when l is not the first of its block. The ring has a power of two number of blocks, so the
+// retention is rounded up to whole blocks, plus one block being filled, and then to a power of two.
+//
+// Keeping the block bases apart from the local sums also bounds the magnitude of the local sums,
+// which matters for a floating point Acc: both are accumulated with CompensatedSum and the bases
+// keep their compensation, so a recent range sum is not swamped by the size of the whole stream.
+template<class T = int, class Acc = PrefixSumType<T>>
+class StreamingPrefixSumArray
+{
+	static_assert(std::is_arithmetic_v<Acc>, "Acc must be an arithmetic type");
+
+	using Sum = CompensatedSum<Acc>;
+
+	static constexpr int block_bits = 12;
+	static constexpr long long block_size = 1ll << block_bits;
+
+	long long n = 0;	// values appended so far
+	long long block_mask;	// number of blocks in the ring - 1
+	std::vector<Acc> local;	// local[slot of i] = sum of the values of i's block up to i
+	std::vector<Sum> base;	// base[ring block] = sum of the stream before the block
+	Sum total;
+	Sum block_sum;
+
+	public:
+
+	// Keeps at least the last `retention` values.
+	StreamingPrefixSumArray(const long long retention);
+
+	// Number of values appended so far
+	long long size() const
+	{
+		return n;
+	}
+
+	// Index of the oldest value that can still be queried
+	long long FirstRetained() const
+	{
+		const long long blocks = block_mask + 1;
+		const long long oldest = n > 0 ? ((n - 1) >> block_bits) - blocks + 1 : 0;
+		return std::max(0ll, oldest) << block_bits;
+	}
+
+	size_t MemoryBytes() const
+	{
+		return local.capacity() * sizeof(Acc) + base.capacity() * sizeof(Sum);
+	}
+
+	void Append(const T& value)
+	{
+		const long long b = (n >> block_bits) & block_mask;
+		const long long offset = n & (block_size - 1);
+		if(offset == 0)
+		{
+			base[b] = total;
+			block_sum = Sum();
+		}
+
+		block_sum.Add(value);
+		total.Add(value);
+		local[(b << block_bits) + offset] = block_sum.Value();
+		++n;
+	}
+
+	// Sum of the stream values [l, r]; l must not be before FirstRetained().
+	Acc RangeSumQuery(const long long l, const long long r) const
+	{
+		assert(FirstRetained() <= l && l <= r && r < n);
+
+		const Sum& base_l = base[(l >> block_bits) & block_mask];
+		const Sum& base_r = base[(r >> block_bits) & block_mask];
+		const Acc local_l = (l & (block_size - 1)) ? local[Slot(l - 1)] : Acc(0);
+
+		// The bases are subtracted first: for floating point they are large and close.
+		return (base_r.sum - base_l.sum) + (base_r.c - base_l.c) + (local[Slot(r)] - local_l);
+	}
+
+	private:
+
+	size_t Slot(const long long i) const
+	{
+		return ((i >> block_bits) & block_mask) << block_bits | (i & (block_size - 1));
+	}
+};
+
+template<class T, class Acc>
+StreamingPrefixSumArray<T, Acc>::StreamingPrefixSumArray(const long long retention)
+{
+	assert(retention > 0);
+
+	const long long blocks = std::bit_ceil((unsigned long long)(retention + block_size - 1) / block_size + 1);
+	block_mask = blocks - 1;
+	local.resize(blocks << block_bits);
+	base.resize(blocks);
+}
+
+#endif
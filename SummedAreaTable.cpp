@@ -0,0 +1,169 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <assert.h>
+#include "SummedAreaTable.h"
+
+using namespace std;
+
+// Every rectangle of small grids, including empty and single row / column ones, against a direct sum.
+template<class T>
+void validate(const int rows, const int cols)
+{
+	mt19937 gen(rows * 1000 + cols);
+	vector<T> grid(size_t(rows) * cols);
+	for(auto& x: grid)
+		x = static_cast<T>(int(gen() % 2001) - 1000) / (is_floating_point_v<T> ? T(7) : T(1));
+
+	SummedAreaTable sat(grid, rows, cols);
+	for(int r1 = 0; r1 < rows; ++r1)
+		for(int r2 = r1; r2 < rows; ++r2)
+			for(int c1 = 0; c1 < cols; ++c1)
+				for(int c2 = c1; c2 < cols; ++c2)
+				{
+					long double expected = 0;
+					for(int r = r1; r <= r2; ++r)
+						for(int c = c1; c <= c2; ++c)
+							expected += grid[size_t(r) * cols + c];
+
+					[[maybe_unused]] const auto sum = sat.RangeSumQuery(r1, c1, r2, c2);
+					assert(fabsl(sum - expected) <= 1e-9L * max(1.0L, fabsl(expected)));
+				}
+}
+
+void test()
+{
+	vector<int> grid{1, 2, 3,
+			 4, 5, 6};
+	SummedAreaTable sat(grid, 2, 3);
+	assert(sat.RangeSumQuery(0, 0, 1, 2) == 21);
+	assert(sat.RangeSumQuery(1, 1, 1, 2) == 11);
+	assert(sat.PrefixSum(0, 1) == 3);
+
+	validate<int>(0, 0);
+	validate<int>(1, 17);
+	validate<int>(13, 1);
+	validate<int>(11, 9);
+	validate<double>(12, 10);
+
+	// More columns than one strip, so that the row sums are carried across strips.
+	const int rows = 3, cols = 5000;
+	vector<int> wide(rows * cols, 1000000);
+	SummedAreaTable wsat(wide, rows, cols);
+	assert(wsat.RangeSumQuery(0, 0, rows-1, cols-1) == 15000000000ll);
+	assert(wsat.RangeSumQuery(1, 2047, 2, 4001) == 2ll * 1955 * 1000000);
+
+	vector<SummedAreaTable<int>::Rect> rects{{0, 0, 2, 4999}, {1, 2047, 2, 4001}, {2, 3, 2, 3}};
+	vector<int64_t> out(rects.size());
+	wsat.RangeSumBatch(rects, out);
+	for(size_t i = 0; i < rects.size(); ++i)
+		assert(out[i] == wsat.RangeSumQuery(rects[i].r1, rects[i].c1, rects[i].r2, rects[i].c2));
+
+	cout << "\nSummedAreaTable tests successful" << endl;
+}
+
+template<class Fn>
+double time_ms(Fn fn)
+{
+	auto start = chrono::steady_clock::now();
+	fn();
+	auto end = chrono::steady_clock::now();
+	return chrono::duration<double, milli>(end-start).count();
+}
+
+// Builds the table one whole row at a time, the construction without column strips.
+unique_ptr<long long[]> build_by_rows(const vector<int>& grid, const int rows, const int cols)
+{
+	const size_t stride = size_t(cols) + 1;
+	auto s = make_unique_for_overwrite<long long[]>((size_t(rows) + 1) * stride);
+	fill(s.get(), s.get() + stride, 0);
+	for(int r = 0; r < rows; ++r)
+	{
+		long long row = 0;
+		s[(r + 1) * stride] = 0;
+		for(int c = 0; c < cols; ++c)
+		{
+			row += grid[size_t(r) * cols + c];
+			s[(r + 1) * stride + c + 1] = s[r * stride + c + 1] + row;
+		}
+	}
+	return s;
+}
+
+void benchmark(const int rows, const int cols)
+{
+	mt19937 gen(rows + cols);
+	vector<int> grid(size_t(rows) * cols);
+	for(auto& x: grid)
+		x = gen() % 1000;
+
+	cout << "\n" << rows << " x " << cols << " grid of int:" << endl;
+
+	long long check = 0;
+	const double by_rows_ms = time_ms([&]() { check = build_by_rows(grid, rows, cols)[size_t(rows + 1) * (cols + 1) - 1]; });
+	unique_ptr<SummedAreaTable<int>> sat;
+	const double strips_ms = time_ms([&]() { sat = make_unique<SummedAreaTable<int>>(grid, rows, cols); });
+	assert(sat->PrefixSum(rows-1, cols-1) == check);
+	cout << "  build by whole rows: " << by_rows_ms << " ms, in column strips: " << strips_ms << " ms" << endl;
+
+	const int num_queries = 1000000;
+	vector<SummedAreaTable<int>::Rect> rects(num_queries);
+	for(auto& q: rects)
+	{
+		int r1 = gen() % rows, r2 = gen() % rows;
+		int c1 = gen() % cols, c2 = gen() % cols;
+		q = {min(r1, r2), min(c1, c2), max(r1, r2), max(c1, c2)};
+	}
+
+	// The row by row approach: one PrefixSumArray per row and a range query on each row of the rectangle.
+	const int row_queries = max(1000, num_queries / rows);
+	vector<PrefixSumArray<int>> row_psa;
+	row_psa.reserve(rows);
+	for(int r = 0; r < rows; ++r)
+		row_psa.emplace_back(span<const int>(grid.data() + size_t(r) * cols, cols));
+
+	long long total1 = 0;
+	const double rows_ns = time_ms([&]() {
+		for(int q = 0; q < row_queries; ++q)
+			for(int r = rects[q].r1; r <= rects[q].r2; ++r)
+				total1 += row_psa[r].RangeSumQuery(rects[q].c1, rects[q].c2);
+	}) * 1e6 / row_queries;
+
+	long long total2 = 0;
+	const double single_ns = time_ms([&]() {
+		for(auto& q: rects)
+			total2 += sat->RangeSumQuery(q.r1, q.c1, q.r2, q.c2);
+	}) * 1e6 / num_queries;
+
+	vector<int64_t> out(num_queries);
+	const double batch_ns = time_ms([&]() { sat->RangeSumBatch(rects, out); }) * 1e6 / num_queries;
+	long long total3 = 0;
+	for(int64_t x: out)
+		total3 += x;
+	assert(total2 == total3);
+
+	long long prefix_total = 0;
+	for(int q = 0; q < row_queries; ++q)
+		prefix_total += out[q];
+	assert(prefix_total == total1);
+
+	cout << "  PrefixSumArray per row: " << rows_ns << " ns/query (" << row_queries << " queries, checksum " << total1 << ")" << endl;
+	cout << "  RangeSumQuery: " << single_ns << " ns/query (checksum " << total2 << ")" << endl;
+	cout << "  RangeSumBatch: " << batch_ns << " ns/query (checksum " << total3 << ")" << endl;
+}
+
+int main()
+{
+	test();
+
+	benchmark(4000, 4000);
+	benchmark(16, 4000000);
+
+	return 0;
+}
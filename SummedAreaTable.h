@@ -0,0 +1,157 @@
+#ifndef SummedAreaTable_H
+#define SummedAreaTable_H
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <assert.h>
+#include "PrefixSumArray.h"
+
+// Sums of rectangles of a static rows x cols grid in O(1), the 2D PrefixSumArray. The grid is
+// row-major; s[(r+1) * (cols+1) + (c+1)] holds the sum of the cells [0, r] x [0, c], accumulated
+// in Acc, and row 0 and column 0 of s are zeros so that a query needs no boundary checks:
+//
+//	sum([r1, r2] x [c1, c2]) = s(r2+1, c2+1) - s(r1, c2+1) - s(r2+1, c1) + s(r1, c1)
+//
+// The table is built in strips of columns narrow enough that the strip of the previous row is
+// still in L1 when the next row adds to it; a row of a wide grid would have left the cache. The
+// running sum of each row is carried from one strip to the next. A floating point Acc uses
+// CompensatedSum both along the rows and down the columns.
+template<class T = int, class Acc = PrefixSumType<T>>
+class SummedAreaTable
+{
+	static_assert(std::is_arithmetic_v<Acc>, "Acc must be an arithmetic type");
+
+	using Sum = CompensatedSum<Acc>;
+
+	int rows;
+	int cols;
+	size_t stride;	// cols + 1
+	std::unique_ptr<Acc[]> s;
+
+	public:
+
+	// Inclusive rectangle [r1, r2] x [c1, c2], for RangeSumBatch
+	struct Rect
+	{
+		int r1;
+		int c1;
+		int r2;
+		int c2;
+	};
+
+	SummedAreaTable(const std::vector<T>& grid, const int irows, const int icols): SummedAreaTable(std::span<const T>(grid), irows, icols) {}
+	SummedAreaTable(std::span<const T> grid, const int irows, const int icols);
+
+	int Rows() const
+	{
+		return rows;
+	}
+
+	int Cols() const
+	{
+		return cols;
+	}
+
+	// Sum of the cells [0, r] x [0, c]
+	Acc PrefixSum(const int r, const int c) const
+	{
+		assert(0 <= r && r < rows && 0 <= c && c < cols);
+		return s[(r + 1) * stride + c + 1];
+	}
+
+	// Sum of the cells [r1, r2] x [c1, c2]
+	Acc RangeSumQuery(const int r1, const int c1, const int r2, const int c2) const
+	{
+		assert(0 <= r1 && r1 <= r2 && r2 < rows);
+		assert(0 <= c1 && c1 <= c2 && c2 < cols);
+
+		const Acc* top = s.get() + r1 * stride;
+		const Acc* bottom = s.get() + (r2 + 1) * stride;
+		return bottom[c2 + 1] - top[c2 + 1] - bottom[c1] + top[c1];
+	}
+
+	// Answers rects[i] into out[i]. While a rectangle is answered, the four corners of the one
+	// prefetch_distance rectangles ahead are prefetched, so that the cache misses of consecutive
+	// queries overlap even when the caller's loop around a single query would not let them.
+	void RangeSumBatch(std::span<const Rect> rects, std::span<Acc> out) const;
+
+	private:
+
+	static constexpr int strip_bytes = 16 * 1024;
+	static constexpr int prefetch_distance = 8;	// rectangles
+};
+
+template<class T>
+SummedAreaTable(const std::vector<T>&, int, int) -> SummedAreaTable<T>;
+
+template<class T, class Acc>
+SummedAreaTable<T, Acc>::SummedAreaTable(std::span<const T> grid, const int irows, const int icols):
+	rows(irows), cols(icols), stride(size_t(icols) + 1), s(std::make_unique_for_overwrite<Acc[]>((size_t(irows) + 1) * (size_t(icols) + 1)))
+{
+	assert(rows >= 0 && cols >= 0);
+	assert(grid.size() == size_t(rows) * cols);
+
+	std::fill(s.get(), s.get() + stride, Acc(0));
+	for(int r = 1; r <= rows; ++r)
+		s[r * stride] = 0;
+
+	const int strip = std::max<int>(1, strip_bytes / sizeof(Acc));
+	std::vector<Sum> row_sum(rows);
+	std::vector<Sum> col_sum(std::is_floating_point_v<Acc> ? cols : 0);
+
+	for(int c0 = 0; c0 < cols; c0 += strip)
+	{
+		const int c1 = std::min(cols, c0 + strip);
+		for(int r = 0; r < rows; ++r)
+		{
+			const T* in = grid.data() + size_t(r) * cols;
+			const Acc* above = s.get() + r * stride + 1;
+			Acc* dst = s.get() + (r + 1) * stride + 1;
+
+			Sum row = row_sum[r];
+			for(int c = c0; c < c1; ++c)
+			{
+				row.Add(in[c]);
+				if constexpr(std::is_floating_point_v<Acc>)
+				{
+					col_sum[c].Add(row);
+					dst[c] = col_sum[c].Value();
+				}
+				else
+					dst[c] = above[c] + row.sum;
+			}
+			row_sum[r] = row;
+		}
+	}
+}
+
+template<class T, class Acc>
+void SummedAreaTable<T, Acc>::RangeSumBatch(std::span<const Rect> rects, std::span<Acc> out) const
+{
+	assert(out.size() >= rects.size());
+
+	auto prefetch = [&](const Rect& rc) {
+		const Acc* top = s.get() + rc.r1 * stride;
+		const Acc* bottom = s.get() + (rc.r2 + 1) * stride;
+		__builtin_prefetch(top + rc.c1);
+		__builtin_prefetch(top + rc.c2 + 1);
+		__builtin_prefetch(bottom + rc.c1);
+		__builtin_prefetch(bottom + rc.c2 + 1);
+	};
+
+	const size_t ahead = std::min(rects.size(), size_t(prefetch_distance));
+	for(size_t q = 0; q < ahead; ++q)
+		prefetch(rects[q]);
+
+	for(size_t q = 0; q < rects.size(); ++q)
+	{
+		if(q + prefetch_distance < rects.size())
+			prefetch(rects[q + prefetch_distance]);
+		out[q] = RangeSumQuery(rects[q].r1, rects[q].c1, rects[q].r2, rects[q].c2);
+	}
+}
+
+#endif
@@ -0,0 +1,138 @@
+// PrefixSumArray build and query throughput, serial against parallel builds, and the append and
+// query cost of StreamingPrefixSumArray. The correctness tests are in PrefixSumArray.cpp.
+//
+//	g++ -std=c++20 -O2 -DNDEBUG bench_prefix_sum.cpp -pthread -o bench_prefix_sum
+//	./bench_prefix_sum	(the largest runs take about 1.5 GB)
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include "PrefixSumArray.h"
+#include "StreamingPrefixSumArray.h"
+
+using namespace std;
+
+template<class Fn>
+double best_ms(Fn fn)
+{
+	double best = 1e300;
+	for(int r = 0; r < 3; ++r)
+	{
+		auto start = chrono::steady_clock::now();
+		fn();
+		auto end = chrono::steady_clock::now();
+		best = min(best, chrono::duration<double, milli>(end-start).count());
+	}
+	return best;
+}
+
+template<class T>
+void benchmark(const string& type, const int n)
+{
+	mt19937 gen(n);
+	vector<T> v(n);
+	for(auto& x: v)
+		x = static_cast<T>(gen() % 1000);
+
+	using Acc = PrefixSumType<T>;
+	const double bytes = double(n) * (sizeof(T) + sizeof(Acc));
+	auto report = [&](const string& msg, const double ms) {
+		cout << "  " << msg << ms << " ms (" << bytes / ms / 1e6 << " GB/s read + written)" << endl;
+	};
+
+	cout << "\n" << type << " x " << n << " build, best of 3 into fresh memory:" << endl;
+
+	Acc last = 0;
+	report("serial loop:          ", best_ms([&]() {
+		auto sums = make_unique_for_overwrite<Acc[]>(n);
+		sums[0] = v[0];
+		for(int i = 1; i < n; ++i)
+			sums[i] = sums[i-1] + v[i];
+		last = sums[n-1];
+	}));
+
+	vector<int> thread_counts{1, 2, 4};
+	if(thread::hardware_concurrency() > 4)
+		thread_counts.push_back(thread::hardware_concurrency());
+	for(int threads: thread_counts)
+	{
+		report("PrefixSumArray, " + to_string(threads) + " thread" + (threads > 1 ? "s: " : ":  "), best_ms([&]() {
+			PrefixSumArray psa(v, threads);
+			last = psa.PrefixSum(n-1);
+		}));
+	}
+
+	PrefixSumArray psa(v);
+	const int num_queries = 10000000;
+	vector<pair<int, int>> queries(num_queries);
+	for(auto& q: queries)
+	{
+		int l = gen() % n;
+		int r = gen() % n;
+		if(l > r)
+			swap(l, r);
+		q = {l, r};
+	}
+
+	Acc total = last;
+	auto start = chrono::steady_clock::now();
+	for(auto& q: queries)
+		total += psa.RangeSumQuery(q.first, q.second);
+	auto end = chrono::steady_clock::now();
+	const double query_ns = chrono::duration<double, nano>(end-start).count() / num_queries;
+
+	cout << "  " << query_ns << " ns/query (checksum " << total << ")" << endl;
+}
+
+// Appends n values keeping the last `retention`, querying random retained ranges every so often.
+void streaming_benchmark(const long long n, const long long retention)
+{
+	mt19937 gen(1);
+	vector<int> values(1 << 20);
+	for(auto& x: values)
+		x = gen() % 1500;
+
+	StreamingPrefixSumArray<int> sums(retention);
+	auto start = chrono::steady_clock::now();
+	for(long long i = 0; i < n; ++i)
+		sums.Append(values[i & (values.size() - 1)]);
+	auto end = chrono::steady_clock::now();
+	const double append_ns = chrono::duration<double, nano>(end-start).count() / n;
+
+	const int num_queries = 10000000;
+	const long long first = sums.FirstRetained();
+	vector<pair<long long, long long>> queries(num_queries);
+	for(auto& q: queries)
+	{
+		long long l = first + gen() % (n - first);
+		long long r = first + gen() % (n - first);
+		if(l > r)
+			swap(l, r);
+		q = {l, r};
+	}
+
+	long long total = 0;
+	start = chrono::steady_clock::now();
+	for(auto& q: queries)
+		total += sums.RangeSumQuery(q.first, q.second);
+	end = chrono::steady_clock::now();
+	const double query_ns = chrono::duration<double, nano>(end-start).count() / num_queries;
+
+	cout << "\nStreaming " << n << " values, retention " << retention << ": " << append_ns << " ns/append, "
+		<< query_ns << " ns/query, " << sums.MemoryBytes() / (1024 * 1024) << " MB, oldest retained index "
+		<< first << " (checksum " << total << ")" << endl;
+}
+
+int main()
+{
+	benchmark<int>("int -> int64", 1000000);
+	benchmark<int>("int -> int64", 100000000);
+	benchmark<double>("double (compensated)", 100000000);
+	streaming_benchmark(1000000000, 4000000);
+
+	return 0;
+}